@@ -0,0 +1,68 @@
+// swift-tools-version:5.7
+//
+//  Package.swift
+//  Timecode Display
+//
+//  The app itself is built with the Xcode project. This builds the parts of it that don't need
+//  AppKit, CoreMIDI or CoreAudio as a library, and the command-line tools that exercise them, so
+//  they can be built, checked and benchmarked anywhere Swift runs:
+//
+//    swift build -c release
+//    swift run -c release tcdcheck
+//    swift run -c release tcdbench
+//
+
+import Foundation
+import PackageDescription
+
+let coreSources = [
+    "F53Timecode.swift",
+    "MTCDecoder.swift",
+    "MTCSource.swift",
+    "TimecodeClock.swift",
+    "TimecodeTracker.swift",
+    "MTCGenerator.swift",
+    "LTCDecoder.swift",
+    "TimecodeRaster.swift",
+    "EventLog.swift",
+    "MIDICapture.swift",
+]
+
+let appOnly = [
+    "AppDelegate.swift",
+    "MIDIReceiver.swift",
+    "TimecodeAnalyzer.swift",
+    "TimecodeView.swift",
+    "MTCOutput.swift",
+    "LTCReceiver.swift",
+    "Assets.xcassets",
+    "Base.lproj",
+    "Timecode_Display.entitlements",
+    "Timecode Display-Bridging-Header.h",
+    "TCDAtomics", // Its own target, below
+]
+
+// On Macs tcdbench also links the copy of SnoizeMIDI the app uses, to compare against it.
+let thirdParty = URL(fileURLWithPath: #filePath).deletingLastPathComponent().appendingPathComponent("third_party").path
+
+let package = Package(
+    name: "TimecodeDisplay",
+    platforms: [.macOS(.v13)],
+    targets: [
+        .target(name: "TCDAtomics", path: "Timecode Display/TCDAtomics"),
+        // The app's types are internal, so the tools reach them with `@testable import`.
+        .target(name: "TimecodeCore", dependencies: ["TCDAtomics"], path: "Timecode Display", exclude: appOnly, sources: coreSources,
+                swiftSettings: [.unsafeFlags(["-enable-testing"])]),
+        // Test data the tools share. The checks are tools rather than a test target so they can run
+        // against release builds, which is also why this is built with testing enabled.
+        .target(name: "TimecodeFixtures", dependencies: ["TimecodeCore"], path: "TimecodeFixtures",
+                swiftSettings: [.unsafeFlags(["-enable-testing"])]),
+        .executableTarget(name: "tcdreplay", dependencies: ["TimecodeCore", "TimecodeFixtures"], path: "tcdreplay"),
+        .executableTarget(name: "tcdltc", dependencies: ["TimecodeCore", "TimecodeFixtures"], path: "tcdltc"),
+        .executableTarget(name: "tcdcheck", dependencies: ["TimecodeCore", "TimecodeFixtures"], path: "tcdcheck"),
+        .executableTarget(name: "tcdbench", dependencies: ["TimecodeCore", "TimecodeFixtures"], path: "tcdbench",
+                          swiftSettings: [.unsafeFlags(["-F", thirdParty], .when(platforms: [.macOS]))],
+                          linkerSettings: [.unsafeFlags(["-F", thirdParty, "-Xlinker", "-rpath", "-Xlinker", thirdParty],
+                                                        .when(platforms: [.macOS]))]),
+    ]
+)
@@ -6,6 +6,8 @@
 //
 
 import Cocoa
+import CoreMIDI
+import UniformTypeIdentifiers
 
 @main
 class AppDelegate: NSObject, NSApplicationDelegate {
@@ -18,31 +20,204 @@ class AppDelegate: NSObject, NSApplicationDelegate {
 
     var receiver = MIDIReceiver()
     var analyzer = TimecodeAnalyzer()
-    var logDateFormatter = DateFormatter()
-    var log: String = ""
+    var mtcOutput = MTCOutput()
+    lazy var ltcReceiver = LTCReceiver(receiver: receiver)
+    var eventLog = EventLog(capacity: 5000, journalDirectory: FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first?.appendingPathComponent("Event Journal"))
+    private var nextLogSequenceShown = 0
+    private var logLinesShown = 0
+    private var logViewUpdatePending = false
+    private let sourceMenu = NSMenu(title: "Source")
+    private let outputMenu = NSMenu(title: "Output")
 
     func applicationDidFinishLaunching(_ aNotification: Notification) {
-        logDateFormatter.dateStyle = .medium
-        logDateFormatter.timeStyle = .medium
         receiver.delegate = analyzer
         receiver.online = true
+        
+        if let mainMenu = NSApp.mainMenu {
+            for menu in [sourceMenu, outputMenu] {
+                let menuItem = NSMenuItem(title: menu.title, action: nil, keyEquivalent: "")
+                menuItem.submenu = menu
+                menu.delegate = self
+                let windowMenuIndex = mainMenu.indexOfItem(withTitle: "Window")
+                mainMenu.insertItem(menuItem, at: windowMenuIndex >= 0 ? windowMenuIndex : mainMenu.numberOfItems)
+            }
+        }
     }
 
     func applicationWillTerminate(_ aNotification: Notification) {
-        // Insert code here to tear down your application
+        receiver.stopRecording() // Writes out what's still buffered
     }
 
     func applicationSupportsSecureRestorableState(_ app: NSApplication) -> Bool {
         return true
     }
     
-    func appendLog(_ string: String) {
-        log.append("\(logDateFormatter.string(from: Date())): \(string)\n")
-        eventLogView.string = log
+    func appendLog(_ record: EventRecord) {
+        eventLog.append(record)
+        if !logViewUpdatePending {
+            logViewUpdatePending = true
+            DispatchQueue.main.async {
+                self.updateLogView()
+            }
+        }
+    }
+    
+    // Appends only the entries the view hasn't shown yet, and drops lines off the top to match the log's capacity.
+    private func updateLogView() {
+        logViewUpdatePending = false
+        guard let textStorage = eventLogView.textStorage else {
+            return
+        }
+        
+        textStorage.beginEditing()
+        var sequence = max(nextLogSequenceShown, eventLog.firstSequence)
+        while let record = eventLog.record(sequence) {
+            textStorage.append(NSAttributedString(string: eventLog.line(for: record), attributes: eventLogView.typingAttributes))
+            logLinesShown += 1
+            sequence += 1
+        }
+        nextLogSequenceShown = sequence
+        
+        while logLinesShown > eventLog.capacity {
+            let firstLine = textStorage.mutableString.range(of: "\n")
+            if firstLine.location == NSNotFound {
+                break
+            }
+            textStorage.deleteCharacters(in: NSRange(location: 0, length: firstLine.location + 1))
+            logLinesShown -= 1
+        }
+        textStorage.endEditing()
+        eventLogView.scrollToEndOfDocument(nil)
+    }
+    
+    @IBAction func exportEventLog(_ sender: Any?) {
+        let panel = NSSavePanel()
+        panel.nameFieldStringValue = "Timecode Display Events.txt"
+        panel.allowedContentTypes = [.plainText]
+        panel.beginSheetModal(for: eventLogWindow) { response in
+            guard response == .OK, let url = panel.url else {
+                return
+            }
+            try? self.eventLog.exportedText().write(to: url, atomically: true, encoding: .utf8)
+        }
     }
     
     func reserReceiver() {
         receiver.reset()
     }
+    
+    @IBAction func toggleCaptureRecording(_ sender: Any?) {
+        if receiver.recorder != nil {
+            let dropped = receiver.stopRecording()
+            if dropped > 0 {
+                let alert = NSAlert()
+                alert.messageText = "Some MIDI wasn't recorded."
+                alert.informativeText = "\(dropped) packets arrived faster than they could be written to the capture, and were left out of it."
+                alert.beginSheetModal(for: timecodeWindow)
+            }
+            return
+        }
+        
+        let panel = NSSavePanel()
+        panel.nameFieldStringValue = "Timecode Display Capture.\(CaptureFormat.pathExtension)"
+        panel.allowedContentTypes = [UTType(filenameExtension: CaptureFormat.pathExtension) ?? .data]
+        panel.beginSheetModal(for: timecodeWindow) { response in
+            guard response == .OK, let url = panel.url else {
+                return
+            }
+            do {
+                try self.receiver.startRecording(to: url)
+            } catch {
+                NSApp.presentError(error)
+            }
+        }
+    }
+    
+    @objc func selectSource(_ sender: NSMenuItem) {
+        if let uniqueID = sender.representedObject as? Int32 {
+            receiver.selection = .only(uniqueID)
+        } else {
+            receiver.selection = sender.tag == 1 ? .priority : .firstActive
+        }
+    }
+    
+    @objc func toggleLTCInput(_ sender: NSMenuItem) {
+        if ltcReceiver.isListening {
+            ltcReceiver.stop()
+            return
+        }
+        do {
+            try ltcReceiver.start()
+        } catch {
+            NSApp.presentError(error)
+        }
+    }
+    
+    @objc func selectOutput(_ sender: NSMenuItem) {
+        mtcOutput.send(toDestinationID: sender.representedObject as? Int32)
+    }
+}
+
+extension AppDelegate: NSMenuItemValidation {
+    func validateMenuItem(_ menuItem: NSMenuItem) -> Bool {
+        if menuItem.action == #selector(toggleCaptureRecording(_:)) {
+            menuItem.title = receiver.recorder != nil ? "Stop Recording Capture" : "Record Capture…"
+        }
+        return true
+    }
+}
+
+extension AppDelegate: NSMenuDelegate {
+    // Rebuilds the Source and Output menus from the current endpoints each time they open.
+    func menuNeedsUpdate(_ menu: NSMenu) {
+        menu.removeAllItems()
+        if menu === outputMenu {
+            updateOutputMenu(menu)
+            return
+        }
+        
+        let firstActive = menu.addItem(withTitle: "First Active Source", action: #selector(selectSource(_:)), keyEquivalent: "")
+        firstActive.tag = 0
+        firstActive.state = receiver.selection == .firstActive ? .on : .off
+        let priority = menu.addItem(withTitle: "Highest Priority Source", action: #selector(selectSource(_:)), keyEquivalent: "")
+        priority.tag = 1
+        priority.state = receiver.selection == .priority ? .on : .off
+        menu.addItem(.separator())
+        let ltc = menu.addItem(withTitle: "Listen for LTC on Audio Input", action: #selector(toggleLTCInput(_:)), keyEquivalent: "")
+        ltc.state = ltcReceiver.isListening ? .on : .off
+        
+        if !receiver.sources.isEmpty {
+            menu.addItem(.separator())
+        }
+        for source in receiver.sources {
+            let item = menu.addItem(withTitle: source.name, action: #selector(selectSource(_:)), keyEquivalent: "")
+            item.representedObject = source.uniqueID
+            if receiver.selection == .only(source.uniqueID) {
+                item.state = .on
+            } else if receiver.currentSource === source {
+                item.state = .mixed
+            }
+        }
+    }
+    
+    private func updateOutputMenu(_ menu: NSMenu) {
+        let none = menu.addItem(withTitle: "No MTC Output", action: #selector(selectOutput(_:)), keyEquivalent: "")
+        none.state = mtcOutput.destinationID == nil ? .on : .off
+        
+        if MIDIGetNumberOfDestinations() > 0 {
+            menu.addItem(.separator())
+        }
+        for index in 0..<MIDIGetNumberOfDestinations() {
+            let endpoint = MIDIGetDestination(index)
+            var uniqueID: Int32 = 0
+            MIDIObjectGetIntegerProperty(endpoint, kMIDIPropertyUniqueID, &uniqueID)
+            var name: Unmanaged<CFString>?
+            MIDIObjectGetStringProperty(endpoint, kMIDIPropertyDisplayName, &name)
+            
+            let item = menu.addItem(withTitle: "Send MTC to " + ((name?.takeRetainedValue() as String?) ?? "Destination \(index + 1)"), action: #selector(selectOutput(_:)), keyEquivalent: "")
+            item.representedObject = uniqueID
+            item.state = mtcOutput.destinationID == uniqueID ? .on : .off
+        }
+    }
 }
 
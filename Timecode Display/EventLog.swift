@@ -0,0 +1,296 @@
+//
+//  EventLog.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+#if canImport(Darwin)
+import Darwin
+#elseif canImport(Glibc)
+import Glibc
+#endif
+
+/// One logged event, stored as a fixed-size 32-byte record and only turned into text when shown or exported.
+struct EventRecord {
+    enum Kind: UInt8 {
+        case start = 1
+        case stop = 2
+        case discontinuity = 3
+    }
+
+    var time: Double // Seconds since the reference date
+    var kind: UInt8
+    var framerate: UInt8
+    var sourceKind: UInt16 = TimecodeKind.mtc.rawValue // Journals from before LTC have 0 here
+    var from: (UInt8, UInt8, UInt8, UInt8) // hh, mm, ss, ff; the only timecode for start and stop
+    var to: (UInt8, UInt8, UInt8, UInt8) = (0, 0, 0, 0)
+    var rmsJitter: Float32 = 0 // Seconds; stop only
+    var maxJitter: Float32 = 0
+    var driftPPM: Float32 = 0
+
+    static func start(_ timecode: F53Timecode, source: TimecodeKind = .mtc, time: Double) -> EventRecord {
+        return EventRecord(time: time, kind: Kind.start.rawValue, framerate: timecode.framerate.rawValue, sourceKind: source.rawValue, from: fields(timecode))
+    }
+
+    static func discontinuity(from: F53Timecode, to: F53Timecode, source: TimecodeKind = .mtc, time: Double) -> EventRecord {
+        return EventRecord(time: time, kind: Kind.discontinuity.rawValue, framerate: to.framerate.rawValue, sourceKind: source.rawValue, from: fields(from), to: fields(to))
+    }
+
+    static func stop(_ timecode: F53Timecode, statistics: TimecodeClock.Statistics, source: TimecodeKind = .mtc, time: Double) -> EventRecord {
+        return EventRecord(time: time, kind: Kind.stop.rawValue, framerate: timecode.framerate.rawValue, sourceKind: source.rawValue, from: fields(timecode), rmsJitter: Float32(statistics.rmsJitter), maxJitter: Float32(statistics.maxJitter), driftPPM: Float32(statistics.driftPPM))
+    }
+
+    private static func fields(_ timecode: F53Timecode) -> (UInt8, UInt8, UInt8, UInt8) {
+        return (UInt8(truncatingIfNeeded: timecode.hh), UInt8(truncatingIfNeeded: timecode.mm), UInt8(truncatingIfNeeded: timecode.ss), UInt8(truncatingIfNeeded: timecode.ff))
+    }
+
+    private static func timecode(_ fields: (UInt8, UInt8, UInt8, UInt8), _ framerate: F53Timecode.Framerate) -> F53Timecode {
+        return F53Timecode(framerate: framerate, hh: UInt(fields.0), mm: UInt(fields.1), ss: UInt(fields.2), ff: UInt(fields.3))
+    }
+
+    var message: String {
+        let framerate = F53Timecode.Framerate(rawValue: self.framerate) ?? ._24
+        let from = EventRecord.timecode(self.from, framerate).stringRepresentation
+        let source = TimecodeKind(rawValue: sourceKind)?.name ?? "Timecode"
+        switch Kind(rawValue: kind) {
+        case .start:
+            return "\(source) start at \(from) - \(framerate.speedAgnosticDescription)"
+        case .stop:
+            return "\(source) stop at \(from)" + String(format: " - jitter %.2f ms RMS, %.2f ms max, drift %+.0f ppm", rmsJitter * 1000, maxJitter * 1000, driftPPM)
+        case .discontinuity:
+            return "\(source) discontinuity - from \(from) to \(EventRecord.timecode(self.to, framerate).stringRepresentation)"
+        case nil:
+            return "Unknown event"
+        }
+    }
+}
+
+/// The most recent events, kept in a fixed-size ring so memory use stays flat however long the show runs.
+/// Every event gets a sequence number, so a view can ask for just the ones it hasn't shown yet.
+final class EventLog {
+    let capacity: Int
+    private var ring: [EventRecord] = []
+    private(set) var totalCount = 0 // Sequence number of the next event
+    private let journal: EventJournal?
+
+    private lazy var dateFormatter: DateFormatter = {
+        let formatter = DateFormatter()
+        formatter.dateStyle = .medium
+        formatter.timeStyle = .medium
+        return formatter
+    }()
+
+    init(capacity: Int, journalDirectory: URL?) {
+        self.capacity = capacity
+        self.ring.reserveCapacity(capacity)
+        self.journal = journalDirectory.flatMap { EventJournal(directory: $0) }
+    }
+
+    func append(_ record: EventRecord) {
+        if ring.count < capacity {
+            ring.append(record)
+        } else {
+            ring[totalCount % capacity] = record
+        }
+        totalCount += 1
+        journal?.append(record)
+    }
+
+    /// Sequence number of the oldest event still in memory.
+    var firstSequence: Int {
+        return totalCount - ring.count
+    }
+
+    func record(_ sequence: Int) -> EventRecord? {
+        guard sequence >= firstSequence && sequence < totalCount else {
+            return nil
+        }
+        return ring[sequence % capacity]
+    }
+
+    func line(for record: EventRecord) -> String {
+        return "\(dateFormatter.string(from: Date(timeIntervalSinceReferenceDate: record.time))): \(record.message)\n"
+    }
+
+    /// Everything in the on-disk journal, oldest first, as text. Falls back to what's in memory
+    /// if there's no journal.
+    func exportedText() -> String {
+        var text = ""
+        if let journal {
+            journal.forEachRecord { text.append(line(for: $0)) }
+        } else {
+            for sequence in firstSequence..<totalCount {
+                text.append(line(for: record(sequence)!))
+            }
+        }
+        return text
+    }
+}
+
+/// An append-only file of `EventRecord`s, written through a memory mapping.
+///
+/// When the current file fills up it's renamed aside and a new one started, keeping a fixed number
+/// of old files, so the journal never grows past `fileSize * keptFiles`.
+///
+/// Each record is written field by field at fixed offsets, little-endian, so the file doesn't
+/// depend on how Swift happens to lay out `EventRecord`: time (Float64 bits) at 0, kind at 8,
+/// framerate at 9, source kind (UInt16) at 10, from (hh, mm, ss, ff) at 12, to at 16, then RMS
+/// jitter, max jitter and drift (Float32 bits) at 20, 24 and 28.
+final class EventJournal {
+    static let fileSize = 1 << 20
+    static let keptFiles = 4
+    static let magic: UInt32 = 0x4a44_4354 // "TCDJ"
+    static let version: UInt32 = 1
+    static let recordSize = 32
+    static let headerSize = 32 // magic, version, record size, record count, then padding
+    static let capacity = (fileSize - headerSize) / recordSize
+
+    private let directory: URL
+    private var fd: Int32 = -1
+    private var mapping: UnsafeMutableRawPointer?
+    private var count = 0
+
+    init?(directory: URL) {
+        self.directory = directory
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        if !mapFile() {
+            return nil
+        }
+    }
+
+    deinit {
+        unmapFile()
+    }
+
+    func append(_ record: EventRecord) {
+        if count == EventJournal.capacity {
+            rotate()
+        }
+        guard let mapping else {
+            return
+        }
+        EventJournal.store(record, at: mapping + EventJournal.headerSize + count * EventJournal.recordSize)
+        count += 1
+        EventJournal.store(UInt32(count), at: mapping + 12)
+    }
+
+    /// Calls `body` for every record in every journal file, oldest first.
+    func forEachRecord(_ body: (EventRecord) -> Void) {
+        if let mapping {
+            msync(mapping, EventJournal.fileSize, MS_SYNC)
+        }
+        for index in (0..<EventJournal.keptFiles).reversed() {
+            guard let data = try? Data(contentsOf: url(index), options: .alwaysMapped), data.count >= EventJournal.headerSize else {
+                continue
+            }
+            data.withUnsafeBytes { bytes in
+                guard let base = bytes.baseAddress, EventJournal.hasCurrentHeader(base) else {
+                    return
+                }
+                let count = min(Int(EventJournal.load(UInt32.self, at: base + 12)), (bytes.count - EventJournal.headerSize) / EventJournal.recordSize)
+                for index in 0..<count {
+                    body(EventJournal.loadRecord(at: base + EventJournal.headerSize + index * EventJournal.recordSize))
+                }
+            }
+        }
+    }
+
+    private func url(_ index: Int) -> URL {
+        return directory.appendingPathComponent(index == 0 ? "Events.tcdjournal" : "Events.\(index).tcdjournal")
+    }
+
+    private func mapFile() -> Bool {
+        fd = open(url(0).path, O_RDWR | O_CREAT, 0o644)
+        guard fd >= 0, ftruncate(fd, off_t(EventJournal.fileSize)) == 0 else {
+            unmapFile()
+            return false
+        }
+        let pointer = mmap(nil, EventJournal.fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        guard let pointer, pointer != UnsafeMutableRawPointer(bitPattern: -1) else {
+            unmapFile()
+            return false
+        }
+        mapping = pointer
+
+        if EventJournal.hasCurrentHeader(UnsafeRawPointer(pointer)) {
+            count = min(Int(EventJournal.load(UInt32.self, at: pointer + 12)), EventJournal.capacity)
+        } else {
+            count = 0
+            EventJournal.store(EventJournal.magic, at: pointer)
+            EventJournal.store(EventJournal.version, at: pointer + 4)
+            EventJournal.store(UInt32(EventJournal.recordSize), at: pointer + 8)
+            EventJournal.store(UInt32(0), at: pointer + 12)
+        }
+        return true
+    }
+
+    private static func hasCurrentHeader(_ header: UnsafeRawPointer) -> Bool {
+        return load(UInt32.self, at: header) == magic && load(UInt32.self, at: header + 4) == version && load(UInt32.self, at: header + 8) == UInt32(recordSize)
+    }
+
+    private static func store<T: FixedWidthInteger>(_ value: T, at pointer: UnsafeMutableRawPointer) {
+        pointer.storeBytes(of: value.littleEndian, as: T.self)
+    }
+
+    private static func load<T: FixedWidthInteger>(_ type: T.Type, at pointer: UnsafeRawPointer) -> T {
+        return T(littleEndian: pointer.load(as: T.self))
+    }
+
+    private static func store(_ record: EventRecord, at pointer: UnsafeMutableRawPointer) {
+        store(record.time.bitPattern, at: pointer)
+        store(record.kind, at: pointer + 8)
+        store(record.framerate, at: pointer + 9)
+        store(record.sourceKind, at: pointer + 10)
+        func storeFields(_ fields: (UInt8, UInt8, UInt8, UInt8), at offset: Int) {
+            (pointer + offset).storeBytes(of: fields.0, as: UInt8.self)
+            (pointer + offset + 1).storeBytes(of: fields.1, as: UInt8.self)
+            (pointer + offset + 2).storeBytes(of: fields.2, as: UInt8.self)
+            (pointer + offset + 3).storeBytes(of: fields.3, as: UInt8.self)
+        }
+        storeFields(record.from, at: 12)
+        storeFields(record.to, at: 16)
+        store(record.rmsJitter.bitPattern, at: pointer + 20)
+        store(record.maxJitter.bitPattern, at: pointer + 24)
+        store(record.driftPPM.bitPattern, at: pointer + 28)
+    }
+
+    private static func loadRecord(at pointer: UnsafeRawPointer) -> EventRecord {
+        func fields(_ offset: Int) -> (UInt8, UInt8, UInt8, UInt8) {
+            return (load(UInt8.self, at: pointer + offset), load(UInt8.self, at: pointer + offset + 1), load(UInt8.self, at: pointer + offset + 2), load(UInt8.self, at: pointer + offset + 3))
+        }
+        return EventRecord(time: Double(bitPattern: load(UInt64.self, at: pointer)),
+                           kind: load(UInt8.self, at: pointer + 8),
+                           framerate: load(UInt8.self, at: pointer + 9),
+                           sourceKind: load(UInt16.self, at: pointer + 10),
+                           from: fields(12),
+                           to: fields(16),
+                           rmsJitter: Float32(bitPattern: load(UInt32.self, at: pointer + 20)),
+                           maxJitter: Float32(bitPattern: load(UInt32.self, at: pointer + 24)),
+                           driftPPM: Float32(bitPattern: load(UInt32.self, at: pointer + 28)))
+    }
+
+    private func unmapFile() {
+        if let mapping {
+            msync(mapping, EventJournal.fileSize, MS_ASYNC)
+            munmap(mapping, EventJournal.fileSize)
+            self.mapping = nil
+        }
+        if fd >= 0 {
+            close(fd)
+            fd = -1
+        }
+        count = 0
+    }
+
+    private func rotate() {
+        unmapFile()
+        let fileManager = FileManager.default
+        try? fileManager.removeItem(at: url(EventJournal.keptFiles - 1))
+        for index in (0..<EventJournal.keptFiles - 1).reversed() {
+            try? fileManager.moveItem(at: url(index), to: url(index + 1))
+        }
+        _ = mapFile()
+    }
+}
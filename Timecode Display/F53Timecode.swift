@@ -22,23 +22,121 @@ struct F53Timecode {
         self.ff = ff
     }
     
+    /// Builds the timecode `framesFromZero` frames after 00:00:00:00, wrapping at 24 hours.
+    init(framerate: Framerate, framesFromZero: UInt) {
+        let table = framerate.table
+        var frames = framesFromZero % table.framesPerDay
+        
+        // Put back the frame numbers that drop frame skips, so we can count at the integer rate.
+        // For non-drop rates droppedPerMinute is 0 and this does nothing.
+        let tenMinuteBlocks = frames / table.framesPerTenMinutes
+        let remainder = frames % table.framesPerTenMinutes
+        frames += 9 * table.droppedPerMinute * tenMinuteBlocks
+        if remainder >= table.droppedPerMinute {
+            frames += table.droppedPerMinute * ((remainder - table.droppedPerMinute) / table.framesPerDroppedMinute)
+        }
+        
+        self.init(framerate: framerate, hh: frames / table.framesPerHour, mm: (frames / table.framesPerMinute) % 60, ss: (frames / table.fps) % 60, ff: frames % table.fps)
+    }
+    
+    /// Length of `stringRepresentation`, and of what `write(into:)` writes.
+    static let formattedLength = 11
+    
     var stringRepresentation: String {
-        if framerate.isDropFrame {
-            return String(format: "%02d:%02d:%02d;%02d", hh, mm, ss, ff)
+        return String(unsafeUninitializedCapacity: F53Timecode.formattedLength) { buffer in
+            write(into: buffer)
         }
-        return String(format: "%02d:%02d:%02d:%02d", hh, mm, ss, ff)
+    }
+    
+    /// Writes HH:MM:SS:FF, or HH:MM:SS;FF for drop frame, as ASCII into the start of `buffer`,
+    /// which must have room for `formattedLength` bytes. Returns the number of bytes written.
+    @discardableResult
+    func write(into buffer: UnsafeMutableBufferPointer<UInt8>) -> Int {
+        precondition(buffer.count >= F53Timecode.formattedLength)
+        let colon = UInt8(ascii: ":")
+        F53Timecode.writeTwoDigits(hh, into: buffer, at: 0)
+        buffer[2] = colon
+        F53Timecode.writeTwoDigits(mm, into: buffer, at: 3)
+        buffer[5] = colon
+        F53Timecode.writeTwoDigits(ss, into: buffer, at: 6)
+        buffer[8] = framerate.isDropFrame ? UInt8(ascii: ";") : colon
+        F53Timecode.writeTwoDigits(ff, into: buffer, at: 9)
+        return F53Timecode.formattedLength
+    }
+    
+    private static func writeTwoDigits(_ value: UInt, into buffer: UnsafeMutableBufferPointer<UInt8>, at index: Int) {
+        let value = UInt8(truncatingIfNeeded: value % 100)
+        buffer[index] = UInt8(ascii: "0") + value / 10
+        buffer[index + 1] = UInt8(ascii: "0") + value % 10
     }
     
     var framesFromZero: UInt {
-        let rawResult = ff + framerate.integerFPS * (ss + 60 * (mm + 60 * hh))
-        if framerate.isDropFrame {
-            return rawResult - 2 * (rawResult / 1800) + 2 * (rawResult / 18000)
-        } else {
-            return rawResult
+        // Drop frame skips frames 0 and 1 at the start of every minute except every tenth one
+        let table = framerate.table
+        let totalMinutes = mm + 60 * hh
+        return ff + table.fps * (ss + 60 * totalMinutes) - table.droppedPerMinute * (totalMinutes - totalMinutes / 10)
+    }
+    
+    /// The timecode `frames` frames later (or earlier, if negative), wrapping at 24 hours.
+    func adding(frames: Int) -> F53Timecode {
+        let framesPerDay = Int(framerate.table.framesPerDay)
+        var result = (Int(framesFromZero) + frames) % framesPerDay
+        if result < 0 {
+            result += framesPerDay
+        }
+        return F53Timecode(framerate: framerate, framesFromZero: UInt(result))
+    }
+    
+    func subtracting(frames: Int) -> F53Timecode {
+        return adding(frames: -frames)
+    }
+    
+    /// Converts a batch of frame counts to timecodes, for log and analysis work.
+    static func timecodes(framerate: Framerate, framesFromZero: [UInt]) -> [F53Timecode] {
+        return framesFromZero.map { F53Timecode(framerate: framerate, framesFromZero: $0) }
+    }
+    
+    /// Writes a batch of frame counts as timecode text, one per line, into `buffer`. Stops when the
+    /// buffer is full. Returns the number of bytes written.
+    static func writeLines(framerate: Framerate, framesFromZero: UnsafeBufferPointer<UInt>, into buffer: UnsafeMutableBufferPointer<UInt8>) -> Int {
+        let lineLength = formattedLength + 1
+        var offset = 0
+        for frames in framesFromZero {
+            if offset + lineLength > buffer.count {
+                break
+            }
+            let line = UnsafeMutableBufferPointer(rebasing: buffer[offset ..< offset + lineLength])
+            F53Timecode(framerate: framerate, framesFromZero: frames).write(into: line)
+            line[formattedLength] = UInt8(ascii: "\n")
+            offset += lineLength
+        }
+        return offset
+    }
+    
+    /// Frame counts for one rate, worked out once so conversions don't have to branch on the rate.
+    struct RateTable {
+        let fps: UInt
+        let framesPerMinute: UInt // Counting every frame number, as if nothing were dropped
+        let framesPerHour: UInt
+        let droppedPerMinute: UInt
+        let framesPerDroppedMinute: UInt // A minute that starts by dropping frame numbers
+        let framesPerTenMinutes: UInt
+        let framesPerDay: UInt
+        
+        init(_ framerate: Framerate) {
+            fps = framerate.integerFPS
+            framesPerMinute = 60 * fps
+            framesPerHour = 3600 * fps
+            droppedPerMinute = framerate.isDropFrame ? 2 : 0
+            framesPerDroppedMinute = framesPerMinute - droppedPerMinute
+            framesPerTenMinutes = 10 * framesPerMinute - 9 * droppedPerMinute
+            framesPerDay = 144 * framesPerTenMinutes
         }
     }
     
-    enum Framerate {
+    private static let rateTables = (0...Framerate._30df.rawValue).map { RateTable(Framerate(rawValue: $0)!) }
+    
+    enum Framerate: UInt8 {
         case _23976
         case _24
         case _24975
@@ -59,6 +157,20 @@ struct F53Timecode {
             }
         }
         
+        /// Frames per second at normal speed, including the 1000/1001 pulldown rates.
+        var nominalFPS: Double {
+            switch self {
+            case ._24, ._25, ._30nd, ._30df:
+                return Double(integerFPS)
+            default:
+                return Double(integerFPS) * 1000.0 / 1001.0
+            }
+        }
+        
+        var table: RateTable {
+            return F53Timecode.rateTables[Int(rawValue)]
+        }
+        
         var isDropFrame: Bool {
             switch self {
             case ._2997df, ._30df:
@@ -0,0 +1,267 @@
+//
+//  LTCDecoder.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+
+/// Decodes SMPTE linear timecode from one channel of audio.
+///
+/// Feed it blocks of float samples, in order. Level crossings are found 16 samples at a time with
+/// SIMD compares, so per-sample work is a few vector instructions and only the crossings themselves
+/// are handled one by one. The intervals between crossings are decoded as biphase mark, with a bit
+/// clock that follows whatever speed the tape or playhead is going, in either direction. It keeps
+/// a few dozen bytes of state and allocates nothing, so one core can decode many channels. Nothing
+/// here depends on CoreAudio, so it builds anywhere Swift does.
+struct LTCDecoder {
+    typealias Vector = SIMD16<Float>
+
+    /// The quietest signal (peak, full scale 1.0) we'll try to decode.
+    static let minimumLevel: Float = 0.01
+    /// Crossings are where the signal passes this fraction of its recent peak, on the way up or down.
+    static let hysteresis: Float = 0.25
+    /// Slowest bit rate followed, in bits per second: a little under a tenth of normal speed at 24 fps.
+    static let minimumBitRate = 150.0
+    /// How fast the longest-interval estimate decays, per interval, so it can follow a speedup.
+    /// A frame can go 130 half-bit intervals between whole bits, so this must stay near 1.
+    static let bitPeriodDecay = 0.998
+
+    static let forwardSync: UInt64 = 0x3ffd // The sync word, as the last 16 bits received
+    static let reverseSync: UInt16 = 0xbffc // The sync word backwards, as the first 16 bits received
+
+    private static let laneBits = SIMD16<UInt32>((0..<16).map { UInt32(1) << UInt32($0) })
+
+    let sampleRate: Double
+
+    // Signal level
+    private var envelope: Float = 0
+    private var isHigh = false
+    private var lastSample: Float = 0
+    private var blockStart = 0.0 // Samples decoded before the current block
+
+    // Bit clock, all in samples
+    private var lastCrossing: Double?
+    private var bitStart = 0.0
+    private var longestInterval = 0.0 // Roughly one bit; intervals under 3/4 of it are half bits
+    private var averageBitPeriod = 0.0
+    private var halfBitPending = false
+
+    // The last 80 bits, newest in bit 0 of `bits`, oldest in bit 15 of `olderBits`
+    private var bits: UInt64 = 0
+    private var olderBits: UInt16 = 0
+    private var bitsSinceSync = 81 // Up to 81, which means we haven't seen a sync word since losing sync
+    private var highestFrameNumber: UInt = 0
+
+    /// True if the last frame was playing backwards
+    private(set) var isReversed = false
+
+    init(sampleRate: Double) {
+        self.sampleRate = sampleRate
+    }
+
+    /// Frames per second the timecode is going by at, or nil if it isn't.
+    var framesPerSecond: Double? {
+        return averageBitPeriod > 0 && lastCrossing != nil ? sampleRate / (80 * averageBitPeriod) : nil
+    }
+
+    mutating func reset() {
+        self = LTCDecoder(sampleRate: sampleRate)
+    }
+
+    /// Decodes `samples`, calling `frameReceived` with each frame and when it was showing, as a
+    /// sample offset from the start of this block. As with MTC, that's three quarters of the way
+    /// through the frame, and it can be before this block started.
+    mutating func decode(_ samples: UnsafeBufferPointer<Float>, frameReceived: (F53Timecode, Double) -> Void) {
+        guard let base = samples.baseAddress, !samples.isEmpty else {
+            return
+        }
+        let count = samples.count
+        let vectorCount = count / Vector.scalarCount * Vector.scalarCount
+
+        // Follow the signal level, so quiet or hot lines both work and noise doesn't cross.
+        var peak = Vector(repeating: 0)
+        var index = 0
+        while index < vectorCount {
+            let vector = LTCDecoder.load(base + index)
+            peak = pointwiseMax(peak, pointwiseMax(vector, -vector))
+            index += Vector.scalarCount
+        }
+        var blockPeak = peak.max()
+        for sample in samples[vectorCount...] {
+            blockPeak = max(blockPeak, abs(sample))
+        }
+        envelope = max(blockPeak, envelope * Float(exp(-Double(count) / (0.5 * sampleRate))))
+        let threshold = max(envelope * LTCDecoder.hysteresis, LTCDecoder.minimumLevel)
+
+        // Find where the signal crosses the threshold band, a vector at a time. Each lane that's
+        // outside the band becomes a bit in `above` or `below`, and the crossings are then just the
+        // alternating first set bits of each.
+        let upper = Vector(repeating: threshold)
+        let lower = Vector(repeating: -threshold)
+        let none = SIMD16<UInt32>(repeating: 0)
+        index = 0
+        while index < vectorCount {
+            let vector = LTCDecoder.load(base + index)
+            let above = none.replacing(with: LTCDecoder.laneBits, where: vector .> upper).wrappedSum()
+            let below = none.replacing(with: LTCDecoder.laneBits, where: vector .< lower).wrappedSum()
+            var from: UInt32 = 0
+            while true {
+                let candidates = (isHigh ? below : above) >> from << from
+                if candidates == 0 {
+                    break
+                }
+                let lane = candidates.trailingZeroBitCount
+                let previous = lane == 0 ? lastSample : base[index + lane - 1]
+                cross(from: previous, to: base[index + lane], at: index + lane, threshold: threshold, frameReceived: frameReceived)
+                from = UInt32(lane + 1)
+            }
+            lastSample = base[index + Vector.scalarCount - 1]
+            index += Vector.scalarCount
+        }
+        while index < count {
+            let sample = base[index]
+            if isHigh ? sample < -threshold : sample > threshold {
+                cross(from: lastSample, to: sample, at: index, threshold: threshold, frameReceived: frameReceived)
+            }
+            lastSample = sample
+            index += 1
+        }
+
+        blockStart += Double(count)
+        if let lastCrossing, blockStart - lastCrossing > sampleRate / LTCDecoder.minimumBitRate {
+            loseSync()
+        }
+    }
+
+    // An unaligned load, since sample buffers only promise Float alignment.
+    private static func load(_ pointer: UnsafePointer<Float>) -> Vector {
+        var vector = Vector()
+        withUnsafeMutableBytes(of: &vector) { bytes in
+            bytes.copyMemory(from: UnsafeRawBufferPointer(start: pointer, count: MemoryLayout<Vector>.size))
+        }
+        return vector
+    }
+
+    // The signal left the threshold band on the other side between the sample before `index` and
+    // the one at it. Interpolates where, and times the interval since the last crossing.
+    private mutating func cross(from previous: Float, to sample: Float, at index: Int, threshold: Float, frameReceived: (F53Timecode, Double) -> Void) {
+        isHigh.toggle()
+        let level = isHigh ? threshold : -threshold
+        let fraction = sample != previous ? min(max((level - previous) / (sample - previous), 0), 1) : 1
+        let position = blockStart + Double(index - 1) + Double(fraction)
+
+        guard let lastCrossing else {
+            self.lastCrossing = position
+            bitStart = position
+            return
+        }
+        let interval = position - lastCrossing
+        self.lastCrossing = position
+        if interval > sampleRate / LTCDecoder.minimumBitRate {
+            loseSync()
+            self.lastCrossing = position
+            bitStart = position
+            return
+        }
+
+        longestInterval = max(interval, longestInterval * LTCDecoder.bitPeriodDecay)
+        if interval > 0.75 * longestInterval {
+            // A whole bit with no transition in the middle: a zero. If half a bit was pending we'd
+            // lined up on the wrong transition, so that's dropped.
+            halfBitPending = false
+            takeBit(0, endingAt: position, frameReceived: frameReceived)
+        } else if halfBitPending {
+            halfBitPending = false
+            takeBit(1, endingAt: position, frameReceived: frameReceived)
+        } else {
+            halfBitPending = true
+        }
+    }
+
+    private mutating func takeBit(_ bit: UInt64, endingAt position: Double, frameReceived: (F53Timecode, Double) -> Void) {
+        let period = position - bitStart
+        bitStart = position
+        averageBitPeriod = averageBitPeriod > 0 ? averageBitPeriod + 0.05 * (period - averageBitPeriod) : period
+
+        olderBits = olderBits << 1 | UInt16(bits >> 63)
+        bits = bits << 1 | bit
+        bitsSinceSync = min(bitsSinceSync + 1, 81)
+        guard bitsSinceSync >= 80 else {
+            return
+        }
+
+        let reversed: Bool
+        if bits & 0xffff == LTCDecoder.forwardSync {
+            reversed = false
+        } else if olderBits == LTCDecoder.reverseSync {
+            reversed = true
+        } else {
+            return
+        }
+
+        // There's no checksum, so only trust a frame that's exactly 80 bits after the last sync word.
+        let follows = bitsSinceSync == 80
+        bitsSinceSync = 0
+        guard follows, let timecode = frame(reversed: reversed) else {
+            return
+        }
+        isReversed = reversed
+        frameReceived(timecode, position - 20 * averageBitPeriod - blockStart)
+    }
+
+    // Reads the frame out of the last 80 bits. Going forwards, bit 0 of the frame came first;
+    // going backwards, it came last.
+    private mutating func frame(reversed: Bool) -> F53Timecode? {
+        func field(_ start: Int, _ width: Int) -> UInt {
+            var value: UInt = 0
+            for offset in 0..<width {
+                let index = reversed ? start + offset : 79 - (start + offset)
+                let bit = index < 64 ? bits >> UInt64(index) & 1 : UInt64(olderBits >> UInt16(index - 64) & 1)
+                value |= UInt(bit) << UInt(offset)
+            }
+            return value
+        }
+
+        let frameUnits = field(0, 4), secondUnits = field(16, 4), minuteUnits = field(32, 4), hourUnits = field(48, 4)
+        guard frameUnits < 10, secondUnits < 10, minuteUnits < 10, hourUnits < 10 else {
+            return nil
+        }
+        let ff = frameUnits + 10 * field(8, 2)
+        let ss = secondUnits + 10 * field(24, 3)
+        let mm = minuteUnits + 10 * field(40, 3)
+        let hh = hourUnits + 10 * field(56, 2)
+        guard ff < 30, ss < 60, mm < 60, hh < 24 else {
+            return nil
+        }
+
+        // LTC doesn't say what rate it is, except for the drop-frame flag. The highest frame number
+        // settles it within a second; until then, guess from how fast frames are going by.
+        highestFrameNumber = max(highestFrameNumber, ff)
+        let framerate: F53Timecode.Framerate
+        if field(10, 1) != 0 {
+            framerate = ._2997df
+        } else if highestFrameNumber >= 25 {
+            framerate = ._2997nd
+        } else if highestFrameNumber == 24 {
+            framerate = ._25
+        } else if let framesPerSecond, framesPerSecond > 27.5 {
+            framerate = ._2997nd
+        } else if let framesPerSecond, framesPerSecond > 24.5 {
+            framerate = ._25
+        } else {
+            framerate = ._24
+        }
+        return F53Timecode(framerate: framerate, hh: hh, mm: mm, ss: ss, ff: ff)
+    }
+
+    private mutating func loseSync() {
+        lastCrossing = nil
+        longestInterval = 0
+        averageBitPeriod = 0
+        halfBitPending = false
+        bitsSinceSync = 81
+        highestFrameNumber = 0
+    }
+}
@@ -0,0 +1,113 @@
+//
+//  LTCReceiver.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+import AVFoundation
+import SnoizeMIDI
+
+enum LTCReceiverError: LocalizedError {
+    case noAudioInput
+
+    var errorDescription: String? {
+        return "There's no audio input to listen for LTC on."
+    }
+}
+
+/// Listens for LTC on every channel of the default audio input, and hands the frames to a
+/// `MIDIReceiver` as extra sources, so they're followed just like MTC.
+final class LTCReceiver {
+    static let bufferSize: AVAudioFrameCount = 1024
+
+    private(set) var isListening = false
+    private let engine = AVAudioEngine()
+    private weak var receiver: MIDIReceiver?
+
+    // Audio tap only, once listening
+    private var sources: [MTCSource] = []
+    private var decoders: [LTCDecoder] = []
+
+    init(receiver: MIDIReceiver) {
+        self.receiver = receiver
+    }
+
+    /// Main thread.
+    func start() throws {
+        guard !isListening else {
+            return
+        }
+        let input = engine.inputNode
+        let format = input.outputFormat(forBus: 0)
+        guard format.channelCount > 0 && format.sampleRate > 0 else {
+            throw LTCReceiverError.noAudioInput // No device, or no permission to use it
+        }
+        let channelCount = Int(format.channelCount)
+
+        // CoreMIDI unique IDs are arbitrary Int32s, so a MIDI source could have any ID we pick.
+        // Count up from the bottom of the range, skipping any a current source has.
+        let takenIDs = Set(receiver?.sources.map { $0.uniqueID } ?? [])
+        var nextID = Int32.min
+        sources = (0..<channelCount).map { channel in
+            while takenIDs.contains(nextID) {
+                nextID += 1
+            }
+            defer {
+                nextID += 1
+            }
+            return MTCSource(uniqueID: nextID, name: "LTC on Audio Input \(channel + 1)", kind: .ltc)
+        }
+        decoders = Array(repeating: LTCDecoder(sampleRate: format.sampleRate), count: channelCount)
+
+        input.installTap(onBus: 0, bufferSize: LTCReceiver.bufferSize, format: format) { [weak self] buffer, time in
+            self?.take(buffer, at: time)
+        }
+        do {
+            try engine.start()
+        } catch {
+            input.removeTap(onBus: 0)
+            throw error
+        }
+        isListening = true
+        receiver?.audioSources = sources
+    }
+
+    /// Main thread.
+    func stop() {
+        guard isListening else {
+            return
+        }
+        engine.inputNode.removeTap(onBus: 0)
+        engine.stop()
+        isListening = false
+        receiver?.audioSources = []
+    }
+
+    // Runs on the audio tap's thread. Decodes every channel of the buffer, pushing frames into each
+    // channel's source, stamped with the host time they were showing.
+    private func take(_ buffer: AVAudioPCMBuffer, at time: AVAudioTime) {
+        guard let channels = buffer.floatChannelData else {
+            return
+        }
+        let startNanos = time.isHostTimeValid ? SMConvertHostTimeToNanos(time.hostTime) : SMConvertHostTimeToNanos(SMGetCurrentHostTime())
+        let nanosPerSample = 1e9 / buffer.format.sampleRate
+        let frameLength = Int(buffer.frameLength)
+
+        for channel in 0..<min(decoders.count, Int(buffer.format.channelCount)) {
+            let source = sources[channel]
+            let samples = UnsafeBufferPointer(start: channels[channel], count: frameLength)
+            var queued = false
+            decoders[channel].decode(samples) { timecode, offset in
+                let nanos = offset >= 0 ? startNanos + UInt64(offset * nanosPerSample) : startNanos - min(startNanos, UInt64(-offset * nanosPerSample))
+                if source.frames.push(timecode, atNanos: nanos) {
+                    queued = true
+                }
+            }
+            if queued {
+                receiver?.framesQueued(from: source)
+            }
+        }
+    }
+}
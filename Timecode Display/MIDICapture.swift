@@ -0,0 +1,313 @@
+//
+//  MIDICapture.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+#if canImport(TCDAtomics)
+import TCDAtomics // Built as a package; the app gets it from the bridging header
+#endif
+
+/// The layout of a capture file: an append-only record of every MIDI packet the receiver saw.
+///
+/// A 16-byte file header (magic, version, and the wall-clock start time as a Double of seconds since
+/// the reference date) is followed by one record per packet: a 16-byte header (host nanoseconds,
+/// source unique ID, byte count), then the packet's bytes padded to a multiple of 8. Every field
+/// is little-endian, whatever the host's byte order.
+enum CaptureFormat {
+    static let magic: UInt32 = 0x4344_4354 // "TCDC"
+    static let version: UInt32 = 1
+    static let fileHeaderSize = 16
+    static let recordHeaderSize = 16
+    static let pathExtension = "tcdcapture"
+
+    static func recordSize(byteCount: Int) -> Int {
+        return recordHeaderSize + ((byteCount + 7) & ~7)
+    }
+
+    static func fileHeader(startTime: Double) -> Data {
+        var header = Data(count: fileHeaderSize)
+        header.withUnsafeMutableBytes { bytes in
+            store(magic, at: bytes.baseAddress!)
+            store(version, at: bytes.baseAddress! + 4)
+            store(startTime.bitPattern, at: bytes.baseAddress! + 8)
+        }
+        return header
+    }
+
+    /// Returns the magic, version and start time from the file header at `pointer`.
+    static func loadFileHeader(at pointer: UnsafeRawPointer) -> (magic: UInt32, version: UInt32, startTime: Double) {
+        return (load(UInt32.self, at: pointer), load(UInt32.self, at: pointer + 4), Double(bitPattern: load(UInt64.self, at: pointer + 8)))
+    }
+
+    static func storeRecordHeader(nanos: UInt64, sourceID: Int32, byteCount: Int, at pointer: UnsafeMutableRawPointer) {
+        store(nanos, at: pointer)
+        store(sourceID, at: pointer + 8)
+        store(UInt32(byteCount), at: pointer + 12)
+    }
+
+    static func loadRecordHeader(at pointer: UnsafeRawPointer) -> (nanos: UInt64, sourceID: Int32, byteCount: Int) {
+        return (load(UInt64.self, at: pointer), load(Int32.self, at: pointer + 8), Int(load(UInt32.self, at: pointer + 12)))
+    }
+
+    private static func store<T: FixedWidthInteger>(_ value: T, at pointer: UnsafeMutableRawPointer) {
+        pointer.storeBytes(of: value.littleEndian, as: T.self)
+    }
+
+    private static func load<T: FixedWidthInteger>(_ type: T.Type, at pointer: UnsafeRawPointer) -> T {
+        return T(littleEndian: pointer.load(as: T.self))
+    }
+}
+
+enum CaptureError: Error {
+    case notACapture
+    case unsupportedVersion
+}
+
+/// Writes a capture without slowing down the MIDI thread.
+///
+/// `record` only copies the packet into a lock-free ring; a timer on a background queue drains the
+/// ring to disk. If the writer ever falls a whole ring behind, packets are dropped and counted
+/// rather than making the MIDI thread wait.
+final class CaptureRecorder {
+    static let ringSize = 1 << 20
+    static let flushInterval = DispatchTimeInterval.milliseconds(100)
+
+    let url: URL
+
+    private let ring: UnsafeMutablePointer<UInt8>
+    private let head: UnsafeMutablePointer<UInt64> // Only the MIDI thread changes it
+    private let tail: UnsafeMutablePointer<UInt64> // Only the write queue changes it
+    private let dropped: UnsafeMutablePointer<UInt64> // Only the MIDI thread changes it
+    private let fileHandle: FileHandle
+    private let writeQueue = DispatchQueue(label: "com.figure53.Timecode-Display.capture", qos: .utility)
+    private let flushTimer: DispatchSourceTimer
+
+    init(url: URL) throws {
+        guard FileManager.default.createFile(atPath: url.path, contents: CaptureFormat.fileHeader(startTime: Date.timeIntervalSinceReferenceDate)) else {
+            throw CocoaError(.fileWriteUnknown)
+        }
+        self.url = url
+        fileHandle = try FileHandle(forWritingTo: url)
+        fileHandle.seekToEndOfFile()
+
+        ring = UnsafeMutablePointer<UInt8>.allocate(capacity: CaptureRecorder.ringSize)
+        head = UnsafeMutablePointer<UInt64>.allocate(capacity: 3)
+        head.initialize(repeating: 0, count: 3)
+        tail = head + 1
+        dropped = head + 2
+
+        flushTimer = DispatchSource.makeTimerSource(queue: writeQueue)
+        flushTimer.schedule(deadline: .now() + CaptureRecorder.flushInterval, repeating: CaptureRecorder.flushInterval)
+        flushTimer.setEventHandler { [weak self] in
+            self?.flush()
+        }
+        flushTimer.resume()
+    }
+
+    deinit {
+        ring.deallocate()
+        head.deallocate()
+    }
+
+    /// Packets dropped because the ring was full.
+    var droppedPackets: UInt64 {
+        return TCDAtomicLoadAcquire(dropped)
+    }
+
+    /// MIDI thread only.
+    func record(_ bytes: UnsafeBufferPointer<UInt8>, sourceID: Int32, atNanos nanos: UInt64) {
+        let size = CaptureFormat.recordSize(byteCount: bytes.count)
+        let writeIndex = TCDAtomicLoadRelaxed(head)
+        if UInt64(CaptureRecorder.ringSize) - (writeIndex - TCDAtomicLoadAcquire(tail)) < UInt64(size) {
+            TCDAtomicStoreRelease(dropped, TCDAtomicLoadRelaxed(dropped) + 1)
+            return
+        }
+
+        var header: (UInt64, UInt64) = (0, 0)
+        withUnsafeMutableBytes(of: &header) { header in
+            CaptureFormat.storeRecordHeader(nanos: nanos, sourceID: sourceID, byteCount: bytes.count, at: header.baseAddress!)
+            copyIn(header.baseAddress!, count: CaptureFormat.recordHeaderSize, at: writeIndex)
+        }
+        if let baseAddress = bytes.baseAddress {
+            copyIn(UnsafeRawPointer(baseAddress), count: bytes.count, at: writeIndex + UInt64(CaptureFormat.recordHeaderSize))
+        }
+        var padding: UInt64 = 0
+        let paddingCount = size - CaptureFormat.recordHeaderSize - bytes.count
+        copyIn(&padding, count: paddingCount, at: writeIndex + UInt64(size - paddingCount))
+
+        TCDAtomicStoreRelease(head, writeIndex + UInt64(size))
+    }
+
+    /// Stops recording, writing out whatever is still in the ring.
+    func close() {
+        flushTimer.cancel()
+        writeQueue.sync {
+            flush()
+            fileHandle.closeFile()
+        }
+    }
+
+    private func copyIn(_ source: UnsafeRawPointer, count: Int, at index: UInt64) {
+        let offset = Int(index & UInt64(CaptureRecorder.ringSize - 1))
+        let first = min(count, CaptureRecorder.ringSize - offset)
+        UnsafeMutableRawPointer(ring + offset).copyMemory(from: source, byteCount: first)
+        if first < count {
+            UnsafeMutableRawPointer(ring).copyMemory(from: source + first, byteCount: count - first)
+        }
+    }
+
+    // Write queue only
+    private func flush() {
+        let readIndex = TCDAtomicLoadRelaxed(tail)
+        let writeIndex = TCDAtomicLoadAcquire(head)
+        guard writeIndex != readIndex else {
+            return
+        }
+
+        let offset = Int(readIndex & UInt64(CaptureRecorder.ringSize - 1))
+        let count = Int(writeIndex - readIndex)
+        let first = min(count, CaptureRecorder.ringSize - offset)
+        fileHandle.write(Data(bytesNoCopy: UnsafeMutableRawPointer(ring + offset), count: first, deallocator: .none))
+        if first < count {
+            fileHandle.write(Data(bytesNoCopy: UnsafeMutableRawPointer(ring), count: count - first, deallocator: .none))
+        }
+        TCDAtomicStoreRelease(tail, writeIndex)
+    }
+}
+
+/// Reads a capture file through a memory mapping.
+struct CaptureReader {
+    let data: Data
+    /// When recording started, in seconds since the reference date
+    let startTime: Double
+
+    init(url: URL) throws {
+        data = try Data(contentsOf: url, options: .alwaysMapped)
+        guard data.count >= CaptureFormat.fileHeaderSize else {
+            throw CaptureError.notACapture
+        }
+        let (magic, version, startTime) = data.withUnsafeBytes { bytes in
+            CaptureFormat.loadFileHeader(at: bytes.baseAddress!)
+        }
+        guard magic == CaptureFormat.magic else {
+            throw CaptureError.notACapture
+        }
+        guard version == CaptureFormat.version else {
+            throw CaptureError.unsupportedVersion
+        }
+        self.startTime = startTime
+    }
+
+    /// Calls `body` with each packet's bytes, source unique ID and host nanoseconds, in the order
+    /// they were recorded. Stops quietly at a truncated final record.
+    func forEachPacket(_ body: (UnsafeBufferPointer<UInt8>, Int32, UInt64) -> Void) {
+        data.withUnsafeBytes { bytes in
+            var offset = CaptureFormat.fileHeaderSize
+            while offset + CaptureFormat.recordHeaderSize <= bytes.count {
+                let (nanos, sourceID, byteCount) = CaptureFormat.loadRecordHeader(at: bytes.baseAddress! + offset)
+                let size = CaptureFormat.recordSize(byteCount: byteCount)
+                guard offset + size <= bytes.count else {
+                    return
+                }
+                let packet = UnsafeBufferPointer(rebasing: bytes.bindMemory(to: UInt8.self)[offset + CaptureFormat.recordHeaderSize ..< offset + CaptureFormat.recordHeaderSize + byteCount])
+                body(packet, sourceID, nanos)
+                offset += size
+            }
+        }
+    }
+}
+
+/// Runs a capture through the same decoding, source arbitration and tracking the app uses live,
+/// without any UI. Given the same capture and options, it always logs the same events.
+struct CaptureReplayer {
+    struct Summary {
+        var packets = 0
+        var bytes = 0
+        var frames = 0
+        var captureDuration = 0.0 // Seconds, first packet to last
+        var elapsed = 0.0 // Seconds spent replaying
+
+        var bytesPerSecond: Double {
+            return elapsed > 0 ? Double(bytes) / elapsed : 0
+        }
+
+        var speed: Double { // Multiple of real time
+            return elapsed > 0 ? captureDuration / elapsed : 0
+        }
+    }
+
+    /// Pace packets as they were recorded, rather than as fast as possible
+    var realTime = false
+    var selection: SourceSelection = .firstActive
+
+    /// Calls `log` with each event. Event times are the capture's start time plus the offset from
+    /// its first packet, so they don't depend on when or how fast the replay runs. Also calls
+    /// `frameReceived` with each frame from the followed source, stamped with the host nanoseconds it was recorded at.
+    func replay(_ reader: CaptureReader, frameReceived: (FrameRing.Entry) -> Void = { _ in }, log: (EventRecord) -> Void) -> Summary {
+        var summary = Summary()
+        var sources: [MTCSource] = []
+        var arbiter = SourceArbiter()
+        arbiter.selection = selection
+        var tracker = TimecodeTracker()
+        var firstNanos: UInt64?
+        var lastNanos: UInt64 = 0
+        let replayStart = DispatchTime.now().uptimeNanoseconds
+
+        func offset(_ nanos: UInt64) -> UInt64 {
+            return nanos - min(nanos, firstNanos ?? nanos)
+        }
+        func time(_ nanos: UInt64) -> Double {
+            return reader.startTime + Double(offset(nanos)) / 1e9
+        }
+
+        reader.forEachPacket { bytes, sourceID, nanos in
+            if firstNanos == nil {
+                firstNanos = nanos
+            }
+            lastNanos = max(lastNanos, nanos)
+            summary.packets += 1
+            summary.bytes += bytes.count
+
+            if realTime {
+                let due = replayStart + offset(nanos)
+                let now = DispatchTime.now().uptimeNanoseconds
+                if due > now {
+                    Thread.sleep(forTimeInterval: Double(due - now) / 1e9)
+                }
+            }
+
+            // Sources are created as they first appear, so that's their priority order.
+            let source: MTCSource
+            if let existing = sources.first(where: { $0.uniqueID == sourceID }) {
+                source = existing
+            } else {
+                source = MTCSource(uniqueID: sourceID, name: "Source \(sourceID)")
+                sources.append(source)
+            }
+
+            if tracker.checkForStop(atNanos: nanos, time: time(nanos), log: log) {
+                // As the app does, so a decoder can't carry half a frame across the stop
+                for source in sources {
+                    source.requestReset()
+                }
+            }
+            if source.take(bytes, atNanos: nanos) {
+                arbiter.drain(sources, atNanos: nanos) { entry, source in
+                    summary.frames += 1
+                    tracker.takeFrame(entry.timecode, atNanos: entry.nanos, isSysEx: entry.isSysEx, kind: source.kind, time: time(entry.nanos), log: log)
+                    frameReceived(entry)
+                }
+            }
+        }
+
+        let end = lastNanos + TimecodeTracker.longestDropoutInterval + 1
+        tracker.checkForStop(atNanos: end, time: time(end), log: log)
+
+        summary.captureDuration = Double(offset(lastNanos)) / 1e9
+        summary.elapsed = Double(DispatchTime.now().uptimeNanoseconds - replayStart) / 1e9
+        return summary
+    }
+}
@@ -6,6 +6,7 @@
 //
 
 import Foundation
+import CoreMIDI
 import SnoizeMIDI
 
 class MIDIReceiver: NSObject {
@@ -21,177 +22,235 @@ class MIDIReceiver: NSObject {
     
     weak var delegate: MIDIReceiverDelegate?
     
-    private let context = MIDIContext()
-    private var stream: PortInputStream?
+    var selection: SourceSelection {
+        get { arbiter.selection }
+        set {
+            arbiter.selection = newValue
+            wakeup.follow(newValue)
+        }
+    }
     
-    private var lastReceivedQuarterFrame: UInt8?
-    private var hh: UInt8 = 0
-    private var mm: UInt8 = 0
-    private var ss: UInt8 = 0
-    private var ff: UInt8 = 0
-    private var validMask: UInt8 = 0
-    private var mtcMode: MTCMode = .invalid
-
-    override init() {
-        self.stream = PortInputStream(midiContext: self.context)
-        super.init()
+    /// Every source we're listening to, in priority order: MIDI sources in CoreMIDI's order, then `audioSources`.
+    private(set) var sources: [MTCSource] = []
+    
+    /// Sources that aren't MIDI endpoints, such as LTC audio channels. Whoever owns them pushes
+    /// frames into them directly, then calls `framesQueued(from:)`.
+    var audioSources: [MTCSource] = [] {
+        didSet {
+            sources = midiSources + audioSources
+        }
     }
     
-    private func start() {
-        let stream = PortInputStream(midiContext: context)
-        for endpoint in context.sources {
-            stream.addSource(endpoint)
+    private var midiSources: [MTCSource] = [] {
+        didSet {
+            sources = midiSources + audioSources
         }
-        stream.messageDestination = self
-        stream.delegate = self
-        self.hh = 0
-        self.mm = 0
-        self.ss = 0
-        self.ff = 0
-        self.validMask = 0
-        self.lastReceivedQuarterFrame = 0
-        self.stream = stream
     }
     
-    private func stop() {
-        self.stream = nil
+    /// The source whose frames were passed on by the last `takeFrames`.
+    var currentSource: MTCSource? {
+        return sources.first { $0.uniqueID == arbiter.currentSourceID }
     }
     
-    func reset() {
-        self.hh = 0
-        self.mm = 0
-        self.ss = 0
-        self.ff = 0
-        self.validMask = 0
-        self.lastReceivedQuarterFrame = 0
-    }
-    
-    enum MTCMode: UInt8 {
-        case invalid = 0xff
-        case _24 = 0
-        case _25 = 1
-        case _30df = 2
-        case _30nd = 3
-        
-        func asFramerate() -> F53Timecode.Framerate {
-            switch self {
-            case ._24:
-                return ._24
-            case ._25:
-                return ._25
-            case ._30df:
-                return ._2997df
-            case ._30nd:
-                return ._2997nd
-            default:
-                return ._24
+    private var client = MIDIClientRef()
+    private var port = MIDIPortRef()
+    private var arbiter = SourceArbiter()
+    private let wakeup = FrameWakeup()
+    
+    // Each connected endpoint, with the reference to its source that CoreMIDI hands back as the
+    // refCon. The connection owns that reference, so the source outlives it.
+    private var connections: [(endpoint: MIDIEndpointRef, refCon: Unmanaged<MTCSource>)] = []
+    
+    // References from connections that have been taken down. CoreMIDI may still be delivering a
+    // packet list to one of them, so they're released once no packet lists are being taken.
+    private var retiredRefCons: [Unmanaged<MTCSource>] = []
+    private let packetListsInFlight: UnsafeMutablePointer<UInt64>
+    
+    // The capture being recorded, if any, as an unretained object pointer the MIDI thread can pick
+    // up without a lock. A stopped recorder is kept alive until the next one stops, in case the
+    // MIDI thread was still writing to it.
+    private let recorderPointer: UnsafeMutablePointer<UInt64>
+    private(set) var recorder: CaptureRecorder?
+    private var retiredRecorder: CaptureRecorder?
+    
+    private static let packetDataOffset = MemoryLayout<MIDIPacket>.offset(of: \MIDIPacket.data)!
+
+    override init() {
+        packetListsInFlight = UnsafeMutablePointer<UInt64>.allocate(capacity: 1)
+        packetListsInFlight.initialize(to: 0)
+        recorderPointer = UnsafeMutablePointer<UInt64>.allocate(capacity: 1)
+        recorderPointer.initialize(to: 0)
+        super.init()
+        MIDIClientCreateWithBlock("Timecode Display" as CFString, &client) { [weak self] notification in
+            if notification.pointee.messageID == .msgSetupChanged {
+                self?.sourceListChanged()
             }
         }
+        MIDIInputPortCreateWithBlock(client, "Timecode Input" as CFString, &port) { [weak self] packetList, refCon in
+            self?.takePacketList(packetList, refCon: refCon)
+        }
     }
-}
-
-extension MIDIReceiver: InputStreamDelegate {
-    func inputStreamReadingSysEx(_ stream: SnoizeMIDI.InputStream, byteCountSoFar: Int, streamSource: SnoizeMIDI.InputStreamSource) {
-        print("reading sysex")
+    
+    deinit {
+        // Once the port's gone, nothing can be delivered to a connection.
+        MIDIPortDispose(port)
+        for connection in connections {
+            connection.refCon.release()
+        }
+        for refCon in retiredRefCons {
+            refCon.release()
+        }
+        packetListsInFlight.deallocate()
+        recorderPointer.deallocate()
     }
     
-    func inputStreamFinishedReadingSysEx(_ stream: SnoizeMIDI.InputStream, byteCount: Int, streamSource: SnoizeMIDI.InputStreamSource, isValid: Bool) {
-        print("finished sysex")
+    private func start() {
+        for index in 0..<MIDIGetNumberOfSources() {
+            let endpoint = MIDIGetSource(index)
+            var uniqueID: Int32 = 0
+            MIDIObjectGetIntegerProperty(endpoint, kMIDIPropertyUniqueID, &uniqueID)
+            var name: Unmanaged<CFString>?
+            MIDIObjectGetStringProperty(endpoint, kMIDIPropertyDisplayName, &name)
+            
+            let source = MTCSource(uniqueID: uniqueID, name: (name?.takeRetainedValue() as String?) ?? "Source \(index + 1)")
+            let refCon = Unmanaged.passRetained(source)
+            if MIDIPortConnectSource(port, endpoint, refCon.toOpaque()) == noErr {
+                midiSources.append(source)
+                connections.append((endpoint, refCon))
+            } else {
+                refCon.release()
+            }
+        }
     }
     
-    func inputStreamSourceListChanged(_ stream: SnoizeMIDI.InputStream) {
-        if online {
-            stop()
-            start()
+    private func stop() {
+        for connection in connections {
+            MIDIPortDisconnectSource(port, connection.endpoint)
+            retiredRefCons.append(connection.refCon)
+        }
+        connections.removeAll()
+        midiSources.removeAll()
+        DispatchQueue.main.async { [weak self] in
+            self?.releaseRetiredRefCons()
         }
     }
-}
-
-extension MIDIReceiver: MessageDestination {
-    func takeMIDIMessages(_ messages: [SnoizeMIDI.Message]) {
-        for message in messages {
-            if let message = message as? SystemCommonMessage, let d1 = message.dataByte1 {
-                switch d1 >> 4 {
-                case 0:
-                    setLowFF(d1)
-                case 1:
-                    setHighFF(d1)
-                case 2:
-                    setLowSS(d1)
-                case 3:
-                    setHighSS(d1)
-                case 4:
-                    setLowMM(d1)
-                case 5:
-                    setHighMM(d1)
-                case 6:
-                    setLowHH(d1)
-                case 7:
-                    setHighHH(d1)
-                default:
-                    break
-                }
+    
+    // Main thread. A packet list CoreMIDI started delivering before the disconnect may still be
+    // using one of the retired references, so wait until none are in flight.
+    private func releaseRetiredRefCons() {
+        guard TCDAtomicLoadAcquire(packetListsInFlight) == 0 else {
+            DispatchQueue.main.asyncAfter(deadline: .now() + .milliseconds(10)) { [weak self] in
+                self?.releaseRetiredRefCons()
             }
+            return
+        }
+        for refCon in retiredRefCons {
+            refCon.release()
         }
+        retiredRefCons.removeAll()
     }
     
-    private func setLowFF(_ lowFF: UInt8) {
-        ff = (ff & 0xf0) | (lowFF & 0x0f);
-        validMask |= 0x1
+    func reset() {
+        for source in sources {
+            source.requestReset()
+        }
     }
     
-    private func setHighFF(_ highFF: UInt8) {
-        ff = (ff & 0x0f) | ((highFF & 0x0f) << 4)
-        validMask |= 0x2
+    /// Main thread. Passes on the frames that have arrived since the last call, from whichever
+    /// source `selection` picks, oldest first, with that source.
+    func takeFrames(_ frameReceived: (FrameRing.Entry, MTCSource) -> Void) {
+        arbiter.drain(sources, atNanos: SMConvertHostTimeToNanos(SMGetCurrentHostTime()), frameReceived: frameReceived)
     }
     
-    private func setLowSS(_ lowSS: UInt8) {
-        ss = (ss & 0xf0) | (lowSS & 0x0f)
-        validMask |= 0x4
+    /// Main thread. Asks for `midiReceiverHasFrames` to be called once the next frame arrives, or
+    /// right away if one has arrived since the last `takeFrames`.
+    func wakeOnNextFrame() {
+        if wakeup.wakeOnNextFrame(sources) {
+            wake()
+        }
     }
     
-    private func setHighSS(_ highSS: UInt8) {
-        ss = (ss & 0x0f) | ((highSS & 0x0f) << 4)
-        if ss == 0 && (ff == 0 || (ff == 2 && mtcMode == ._30df)) {
-            mm += 1 // Because of the way MTC is structured, the minutes place won't be updated on the frame where it changes over. Dumb? Yes. But this fixes it.
+    /// Any thread. Called after pushing frames into `source`, to wake the delegate if it asked to be.
+    func framesQueued(from source: MTCSource) {
+        if wakeup.framesQueued(from: source) {
+            wake()
         }
-        validMask |= 0x8
-        reportFrameReceived()
     }
     
-    private func setLowMM(_ lowMM: UInt8) {
-        mm = (mm & 0xf0) | (lowMM & 0xf)
-        validMask |= 0x10
+    private func wake() {
+        DispatchQueue.main.async { [weak self] in
+            guard let self else {
+                return
+            }
+            self.delegate?.midiReceiverHasFrames(self)
+        }
     }
     
-    private func setHighMM(_ highMM: UInt8) {
-        mm = (mm & 0x0f) | ((highMM & 0x0f) << 4)
-        validMask |= 0x20
+    /// Starts recording every packet from every source to a capture file at `url`.
+    func startRecording(to url: URL) throws {
+        stopRecording()
+        let recorder = try CaptureRecorder(url: url)
+        self.recorder = recorder
+        TCDAtomicStoreRelease(recorderPointer, UInt64(UInt(bitPattern: Unmanaged.passUnretained(recorder).toOpaque())))
     }
     
-    private func setLowHH(_ lowHH: UInt8) {
-        hh = (hh & 0xf0) | (lowHH & 0x0f)
-        validMask |= 0x40
+    /// Returns the number of packets that arrived too fast to be written, and aren't in the capture.
+    @discardableResult
+    func stopRecording() -> UInt64 {
+        guard let recorder else {
+            return 0
+        }
+        TCDAtomicStoreRelease(recorderPointer, 0)
+        recorder.close()
+        retiredRecorder = recorder
+        self.recorder = nil
+        return recorder.droppedPackets
     }
     
-    private func setHighHH(_ highHH: UInt8) {
-        hh = (hh & 0x0f) | ((highHH & 0x01) << 4)
-        mtcMode = MTCMode(rawValue: ((highHH & 0x06) >> 1)) ?? .invalid
-        ff += 1
-        validMask |= 0x80
-        reportFrameReceived()
+    private func sourceListChanged() {
+        if online {
+            stop()
+            start()
+        }
     }
-    
-    private func reportFrameReceived() {
-        if validMask != 0xff || mtcMode == .invalid {
+}
+
+extension MIDIReceiver {
+    // Runs on CoreMIDI's receive thread. Nothing in here locks or allocates, except the one
+    // wakeup when the main thread has asked for it. Recording only copies into the recorder's ring.
+    private func takePacketList(_ packetList: UnsafePointer<MIDIPacketList>, refCon: UnsafeMutableRawPointer?) {
+        guard let refCon else {
             return
         }
+        _ = TCDAtomicAdd(packetListsInFlight, 1)
+        defer {
+            _ = TCDAtomicSubtract(packetListsInFlight, 1)
+        }
+        let source = Unmanaged<MTCSource>.fromOpaque(refCon).takeUnretainedValue()
+        let recorder = UnsafeRawPointer(bitPattern: UInt(TCDAtomicLoadAcquire(recorderPointer))).map {
+            Unmanaged<CaptureRecorder>.fromOpaque($0).takeUnretainedValue()
+        }
         
-        let tc = F53Timecode(framerate: mtcMode.asFramerate(), hh: UInt(hh), mm: UInt(mm), ss: UInt(ss), ff: UInt(ff))
-        delegate?.midiReceiver(self, didReceive: tc)
+        var queued = false
+        SMPacketListApply(packetList) { packet in
+            let data = (UnsafeRawPointer(packet) + MIDIReceiver.packetDataOffset).assumingMemoryBound(to: UInt8.self)
+            let bytes = UnsafeBufferPointer(start: data, count: Int(packet.pointee.length))
+            let hostTime = packet.pointee.timeStamp != 0 ? packet.pointee.timeStamp : SMGetCurrentHostTime()
+            let nanos = SMConvertHostTimeToNanos(hostTime)
+            recorder?.record(bytes, sourceID: source.uniqueID, atNanos: nanos)
+            if source.take(bytes, atNanos: nanos) {
+                queued = true
+            }
+        }
+        
+        if queued {
+            framesQueued(from: source)
+        }
     }
 }
 
 protocol MIDIReceiverDelegate: AnyObject {
-    func midiReceiver(_ sender: MIDIReceiver, didReceive timecode: F53Timecode)
+    /// Called on the main queue when a frame arrives after `wakeOnNextFrame`. The delegate then
+    /// collects frames with `takeFrames`, as often as it likes, until it asks to be woken again.
+    func midiReceiverHasFrames(_ sender: MIDIReceiver)
 }
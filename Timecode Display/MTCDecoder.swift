@@ -0,0 +1,257 @@
+//
+//  MTCDecoder.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+
+/// The frame rate carried in the high-hours quarter frame.
+enum MTCMode: UInt8 {
+    case invalid = 0xff
+    case _24 = 0
+    case _25 = 1
+    case _30df = 2
+    case _30nd = 3
+
+    /// The rate code MTC uses for `framerate`. MTC can't tell the pulldown rates from the
+    /// integer ones, so they share a code and the difference is only in how fast frames go by.
+    init(_ framerate: F53Timecode.Framerate) {
+        switch framerate {
+        case ._23976, ._24:
+            self = ._24
+        case ._24975, ._25:
+            self = ._25
+        case ._2997nd, ._30nd:
+            self = ._30nd
+        case ._2997df, ._30df:
+            self = ._30df
+        }
+    }
+
+    func asFramerate() -> F53Timecode.Framerate {
+        switch self {
+        case ._24:
+            return ._24
+        case ._25:
+            return ._25
+        case ._30df:
+            return ._2997df
+        case ._30nd:
+            return ._2997nd
+        default:
+            return ._24
+        }
+    }
+}
+
+/// Decodes MIDI Time Code straight from raw MIDI bytes.
+///
+/// Feed it the bytes of each incoming packet, in order. It follows quarter frames, and also
+/// recognizes full-frame MTC and MMC Locate SysEx messages as their bytes arrive, without
+/// buffering them. It skips everything else without looking at it, allocates nothing, and keeps
+/// everything it knows in a single 16-byte `State`. Nothing here depends on CoreMIDI, so it
+/// builds anywhere Swift does.
+struct MTCDecoder {
+    struct State {
+        var hh: UInt8 = 0
+        var mm: UInt8 = 0
+        var ss: UInt8 = 0
+        var ff: UInt8 = 0
+        var validMask: UInt8 = 0
+        var mode: UInt8 = MTCMode.invalid.rawValue
+        var status: UInt8 = 0 // Status byte whose data bytes we're currently reading, or 0
+        var sysExKind: UInt8 = SysExKind.ignored.rawValue
+        var sysExIndex: UInt8 = 0 // Data bytes seen since 0xF0, saturating
+        var sysExHH: UInt8 = 0 // Time fields of a SysEx message, held until its 0xF7 arrives
+        var sysExMM: UInt8 = 0
+        var sysExSS: UInt8 = 0
+        var sysExFF: UInt8 = 0
+        var reserved: (UInt8, UInt8, UInt8) = (0, 0, 0)
+    }
+
+    /// What the SysEx message currently being read has turned out to be, so far.
+    enum SysExKind: UInt8 {
+        case ignored = 0
+        case universalRealtime = 1 // F0 7F <device>, sub-ID not yet known
+        case fullFrame = 2 // F0 7F <device> 01 01 hr mn sc fr F7
+        case mmcCommand = 3 // F0 7F <device> 06 ...
+        case mmcLocate = 4 // F0 7F <device> 06 44 06 01 hr mn sc fr st F7
+    }
+
+    private(set) var state = State()
+
+    var mtcMode: MTCMode {
+        return MTCMode(rawValue: state.mode) ?? .invalid
+    }
+
+    mutating func reset() {
+        state = State()
+    }
+
+    /// Runs `bytes` through the decoder, calling `frameReceived` each time a complete frame is known.
+    /// Its second argument is true if the frame came from a full-frame or MMC Locate message, which
+    /// names the frame showing as it arrives, rather than from quarter frames, which name one that
+    /// began three quarters of a frame earlier.
+    mutating func decode(_ bytes: UnsafeBufferPointer<UInt8>, frameReceived: (F53Timecode, Bool) -> Void) {
+        for byte in bytes {
+            if byte >= 0xf8 {
+                // Realtime messages can appear anywhere, even between a status byte and its data.
+                continue
+            }
+            if byte >= 0x80 {
+                if byte == 0xf7 && state.status == 0xf0 && finishSysEx() {
+                    frameReceived(timecode, true)
+                }
+                // Every other status byte replaces the running status, and cuts off any unfinished SysEx.
+                state.status = byte
+                if byte == 0xf0 {
+                    state.sysExKind = SysExKind.universalRealtime.rawValue
+                    state.sysExIndex = 0
+                }
+                continue
+            }
+            if state.status == 0xf1 {
+                // System common messages don't set running status, so only the first data byte counts.
+                state.status = 0
+                if takeQuarterFrame(byte) {
+                    frameReceived(timecode, false)
+                }
+            } else if state.status == 0xf0 && state.sysExKind != SysExKind.ignored.rawValue {
+                takeSysExByte(byte)
+            }
+        }
+    }
+
+    /// Decodes a single quarter-frame data byte. Returns true if a complete frame is now available.
+    mutating func takeQuarterFrame(_ d1: UInt8) -> Bool {
+        let nibble = d1 & 0x0f
+        switch d1 >> 4 {
+        case 0:
+            state.ff = (state.ff & 0xf0) | nibble
+            state.validMask |= 0x1
+        case 1:
+            state.ff = (state.ff & 0x0f) | (nibble << 4)
+            state.validMask |= 0x2
+        case 2:
+            state.ss = (state.ss & 0xf0) | nibble
+            state.validMask |= 0x4
+        case 3:
+            state.ss = (state.ss & 0x0f) | (nibble << 4)
+            if state.ss == 0 && (state.ff == 0 || (state.ff == 2 && state.mode == MTCMode._30df.rawValue)) {
+                state.mm &+= 1 // Because of the way MTC is structured, the minutes place won't be updated on the frame where it changes over. Dumb? Yes. But this fixes it.
+            }
+            state.validMask |= 0x8
+            return isComplete
+        case 4:
+            state.mm = (state.mm & 0xf0) | nibble
+            state.validMask |= 0x10
+        case 5:
+            state.mm = (state.mm & 0x0f) | (nibble << 4)
+            state.validMask |= 0x20
+        case 6:
+            state.hh = (state.hh & 0xf0) | nibble
+            state.validMask |= 0x40
+        default:
+            state.hh = (state.hh & 0x0f) | ((nibble & 0x01) << 4)
+            state.mode = (nibble & 0x06) >> 1
+            state.ff &+= 1
+            state.validMask |= 0x80
+            return isComplete
+        }
+        return false
+    }
+
+    /// Matches one SysEx data byte against the messages we care about, giving up as soon as it can't be one.
+    private mutating func takeSysExByte(_ byte: UInt8) {
+        let index = state.sysExIndex
+        state.sysExIndex = index == 0xff ? index : index + 1
+
+        switch (SysExKind(rawValue: state.sysExKind) ?? .ignored, index) {
+        case (.universalRealtime, 0):
+            if byte != 0x7f {
+                state.sysExKind = SysExKind.ignored.rawValue
+            }
+        case (.universalRealtime, 1):
+            break // Device ID; we listen to all of them
+        case (.universalRealtime, 2):
+            switch byte {
+            case 0x01:
+                state.sysExKind = SysExKind.fullFrame.rawValue
+            case 0x06:
+                state.sysExKind = SysExKind.mmcCommand.rawValue
+            default:
+                state.sysExKind = SysExKind.ignored.rawValue
+            }
+        case (.fullFrame, 3):
+            if byte != 0x01 {
+                state.sysExKind = SysExKind.ignored.rawValue
+            }
+        case (.fullFrame, 4...7):
+            takeSysExTimeField(byte, at: index - 4)
+        case (.mmcCommand, 3):
+            state.sysExKind = byte == 0x44 ? SysExKind.mmcLocate.rawValue : SysExKind.ignored.rawValue
+        case (.mmcLocate, 4):
+            if byte != 0x06 { // Byte count
+                state.sysExKind = SysExKind.ignored.rawValue
+            }
+        case (.mmcLocate, 5):
+            if byte != 0x01 { // TARGET; the other sub-command points at an information field we don't track
+                state.sysExKind = SysExKind.ignored.rawValue
+            }
+        case (.mmcLocate, 6...9):
+            takeSysExTimeField(byte, at: index - 6)
+        default:
+            break // Subframes, further MMC commands, or trailing bytes we don't need
+        }
+    }
+
+    /// Stores the hours, minutes, seconds or frames byte of a full-frame or MMC time.
+    /// Both use the same layout: 0rrhhhhh, then minutes, seconds and frames in their low bits.
+    private mutating func takeSysExTimeField(_ byte: UInt8, at field: UInt8) {
+        switch field {
+        case 0:
+            state.sysExHH = byte & 0x7f
+        case 1:
+            state.sysExMM = byte & 0x3f
+        case 2:
+            state.sysExSS = byte & 0x3f
+        default:
+            state.sysExFF = byte & 0x1f
+        }
+    }
+
+    /// Called when 0xF7 ends a SysEx message. If it was a complete full-frame or locate message,
+    /// seeds the quarter-frame state with its time and returns true.
+    private mutating func finishSysEx() -> Bool {
+        let kind = SysExKind(rawValue: state.sysExKind) ?? .ignored
+        let length = state.sysExIndex
+        state.sysExKind = SysExKind.ignored.rawValue
+
+        switch kind {
+        case .fullFrame where length == 8:
+            break
+        case .mmcLocate where length >= 10:
+            break
+        default:
+            return false
+        }
+
+        state.hh = state.sysExHH & 0x1f
+        state.mm = state.sysExMM
+        state.ss = state.sysExSS
+        state.ff = state.sysExFF
+        state.mode = (state.sysExHH >> 5) & 0x03
+        state.validMask = 0xff
+        return true
+    }
+
+    var isComplete: Bool {
+        return state.validMask == 0xff && state.mode != MTCMode.invalid.rawValue
+    }
+
+    var timecode: F53Timecode {
+        return F53Timecode(framerate: mtcMode.asFramerate(), hh: UInt(state.hh), mm: UInt(state.mm), ss: UInt(state.ss), ff: UInt(state.ff))
+    }
+}
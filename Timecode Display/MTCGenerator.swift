@@ -0,0 +1,207 @@
+//
+//  MTCGenerator.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+
+/// Regenerates clean quarter-frame MTC from the frames we receive.
+///
+/// Incoming frames only steer a `TimecodeClock`; the output runs on its own timeline, which
+/// follows the clock's rate and slews gently toward its phase, so jitter and dropped messages on
+/// the input don't reach the output. If the input stops, the output keeps going at the last rate
+/// for `freewheelInterval` before it stops too. A jump on the input relocks the output to it.
+///
+/// Nothing here sends anything or reads a clock. The caller wakes up every so often and asks for
+/// every message due in the next few milliseconds, each with the host time it should go out at,
+/// so it can send them all in one batch and let the MIDI driver do the fine timing.
+struct MTCGenerator {
+    /// How long (ns) to keep sending after the last frame arrived
+    static let freewheelInterval: UInt64 = 2_000_000_000
+    /// A phase error this large, in frames, relocks the output rather than slewing
+    static let relockThreshold = 1.0
+    /// Time (seconds) over which a smaller phase error is slewed out
+    static let slewTime = 1.0
+    /// Fastest the output may run faster or slower than the input rate while slewing
+    static let maxSlew = 0.01
+
+    private var clock = TimecodeClock()
+    private var lastFrameNanos: UInt64?
+    private var relockNeeded = true
+
+    // The output timeline: the next quarter frame to send, counting from 00:00:00:00 in quarter
+    // frames, and when it's due. Nanoseconds are kept as a Double so fractional periods don't
+    // accumulate rounding error.
+    private(set) var framerate: F53Timecode.Framerate?
+    private var nextQuarterFrame: UInt = 0
+    private var nextNanos = 0.0
+    private var quarterFrameNanos = 0.0
+    private var lastScheduledNanos = 0.0 // A relock starts after this, so it can't overlap what's already been sent
+    private var sequence: (UInt8, UInt8, UInt8, UInt8, UInt8) = (0, 0, 0, 0, 0) // hh, mm, ss, ff, mode of the current 8-piece message
+
+    /// True while there's output to send.
+    var isRunning: Bool {
+        return lastFrameNanos != nil
+    }
+
+    mutating func reset() {
+        self = MTCGenerator()
+    }
+
+    /// Feeds in a frame received at `nanos`. `isSysEx` is as in `TimecodeClock.takeFrame`.
+    mutating func takeFrame(_ timecode: F53Timecode, atNanos nanos: UInt64, isSysEx: Bool = false) {
+        if !clock.takeFrame(timecode, atNanos: nanos, isSysEx: isSysEx) {
+            relockNeeded = true
+        }
+        lastFrameNanos = nanos
+    }
+
+    /// Calls `emit` with each message due before `horizon`, and the time (host nanoseconds) it's
+    /// due, in order. `now` is the current time, so a relock never schedules anything in the past.
+    /// If `emit` returns false, the message wasn't taken, and it'll be the first one next time.
+    mutating func generate(atNanos now: UInt64, through horizon: UInt64, emit: (UnsafeBufferPointer<UInt8>, UInt64) -> Bool) {
+        guard let lastFrameNanos else {
+            return
+        }
+        if relockNeeded || clock.framerate != framerate {
+            guard relock(after: now) else {
+                return
+            }
+        }
+
+        let stopNanos = Double(lastFrameNanos + MTCGenerator.freewheelInterval)
+        var message: (UInt8, UInt8) = (0xf1, 0)
+        while nextNanos < Double(horizon) {
+            if nextNanos > stopNanos {
+                reset()
+                return
+            }
+
+            let piece = UInt8(nextQuarterFrame % 8)
+            if piece == 0 {
+                guard let error = phaseError() else {
+                    return
+                }
+                if abs(error) > MTCGenerator.relockThreshold {
+                    guard relock(after: now) else {
+                        return
+                    }
+                    continue
+                }
+                startSequence(slewingOut: error)
+            }
+            message.1 = piece << 4 | MTCGenerator.quarterFrameNibble(piece, of: sequence)
+            let due = UInt64(nextNanos.rounded())
+            let taken = withUnsafeBytes(of: &message) { bytes in
+                emit(bytes.bindMemory(to: UInt8.self), due)
+            }
+            guard taken else {
+                return
+            }
+            lastScheduledNanos = nextNanos
+
+            nextQuarterFrame += 1
+            nextNanos += quarterFrameNanos
+        }
+    }
+
+    /// As `generate`, for a caller that sends messages in batches that only hold so many, such as
+    /// MIDI packet lists. `add` puts a message in the current batch, returning false if it's full;
+    /// `send` sends the batch and starts an empty one. The caller starts with an empty batch, and
+    /// `send` is only called for batches with something in them.
+    mutating func generateBatches(atNanos now: UInt64, through horizon: UInt64, add: (UnsafeBufferPointer<UInt8>, UInt64) -> Bool, send: () -> Void) {
+        var full = true
+        while full {
+            full = false
+            var added = 0
+            generate(atNanos: now, through: horizon) { bytes, nanos in
+                guard add(bytes, nanos) else {
+                    full = true
+                    return false
+                }
+                added += 1
+                return true
+            }
+            guard added > 0 else {
+                return // Nothing was due, or a message didn't fit even in an empty batch
+            }
+            send()
+        }
+    }
+
+    // Starts the output at the first even frame after `now` and after anything already scheduled,
+    // since each 8-piece message spans two frames.
+    private mutating func relock(after now: UInt64) -> Bool {
+        let start = max(Double(now), lastScheduledNanos)
+        guard let framerate = clock.framerate, let position = clock.position(atNanos: UInt64(start.rounded())), position >= 0, clock.estimatedFPS > 0 else {
+            return false
+        }
+        let startFrame = (UInt(position) / 2 + 1) * 2
+        self.framerate = framerate
+        relockNeeded = false
+        nextQuarterFrame = startFrame * 4
+        nextNanos = start + (Double(startFrame) - position) / clock.estimatedFPS * 1e9
+        quarterFrameNanos = 1e9 / (4 * clock.estimatedFPS)
+        return true
+    }
+
+    // How far, in frames, the output has drifted ahead of (negative) or behind (positive) the clock
+    // at the start of the next message. Also wraps the output at midnight.
+    private mutating func phaseError() -> Double? {
+        guard let framerate, let position = clock.position(atNanos: UInt64(nextNanos.rounded())) else {
+            return nil
+        }
+        let framesPerDay = framerate.table.framesPerDay
+        if nextQuarterFrame >= 4 * framesPerDay {
+            nextQuarterFrame -= 4 * framesPerDay
+        }
+
+        var error = position - Double(nextQuarterFrame / 4)
+        if error > Double(framesPerDay / 2) {
+            error -= Double(framesPerDay) // One side has wrapped past midnight and the other hasn't yet
+        } else if error < -Double(framesPerDay / 2) {
+            error += Double(framesPerDay)
+        }
+        return error
+    }
+
+    // Works out the time fields of the message about to start, and sets the rate for the two
+    // frames it spans so that `error` is slewed out over `slewTime`.
+    private mutating func startSequence(slewingOut error: Double) {
+        let rate = clock.estimatedFPS
+        let slew = min(max(error / (rate * MTCGenerator.slewTime), -MTCGenerator.maxSlew), MTCGenerator.maxSlew)
+        quarterFrameNanos = 1e9 / (4 * rate * (1 + slew))
+
+        let timecode = F53Timecode(framerate: framerate ?? ._24, framesFromZero: nextQuarterFrame / 4)
+        sequence = MTCGenerator.sequence(for: timecode)
+    }
+
+    /// The hh, mm, ss, ff and mode fields of the 8-piece message that sends `timecode`.
+    static func sequence(for timecode: F53Timecode) -> (UInt8, UInt8, UInt8, UInt8, UInt8) {
+        return (UInt8(timecode.hh), UInt8(timecode.mm), UInt8(timecode.ss), UInt8(timecode.ff), MTCMode(timecode.framerate).rawValue)
+    }
+
+    /// The data nibble of quarter frame `piece` (0 to 7) of the message with the fields in `sequence`.
+    static func quarterFrameNibble(_ piece: UInt8, of sequence: (UInt8, UInt8, UInt8, UInt8, UInt8)) -> UInt8 {
+        switch piece {
+        case 0:
+            return sequence.3 & 0x0f
+        case 1:
+            return sequence.3 >> 4 & 0x01
+        case 2:
+            return sequence.2 & 0x0f
+        case 3:
+            return sequence.2 >> 4 & 0x03
+        case 4:
+            return sequence.1 & 0x0f
+        case 5:
+            return sequence.1 >> 4 & 0x03
+        case 6:
+            return sequence.0 & 0x0f
+        default:
+            return sequence.4 << 1 | (sequence.0 >> 4 & 0x01)
+        }
+    }
+}
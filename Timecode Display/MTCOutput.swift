@@ -0,0 +1,104 @@
+//
+//  MTCOutput.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+import CoreMIDI
+import SnoizeMIDI
+
+/// Sends regenerated MTC to one MIDI destination.
+///
+/// The main thread pushes the frames it follows into `frames`. A timer on the output's own queue
+/// wakes every `batchInterval`, feeds them to an `MTCGenerator`, and sends everything due in the
+/// next `lookahead` as one packet list of timestamped quarter frames, so it wakes up a few dozen
+/// times a second rather than for every quarter frame, and a busy main thread can't delay output.
+final class MTCOutput {
+    static let batchInterval = DispatchTimeInterval.milliseconds(20)
+    static let lookahead: UInt64 = 40_000_000 // ns
+    static let packetListSize = 1024
+
+    let frames = FrameRing(capacity: 64)
+
+    /// Unique ID of the destination to send to, or nil to send nothing. Main thread only.
+    private(set) var destinationID: Int32?
+
+    private var client = MIDIClientRef()
+    private var port = MIDIPortRef()
+    private let queue = DispatchQueue(label: "com.figure53.Timecode-Display.mtc-output", qos: .userInteractive)
+    private let timer: DispatchSourceTimer
+    private var timerRunning = false
+
+    // Output queue only
+    private var destination = MIDIEndpointRef()
+    private var generator = MTCGenerator()
+    private let packetList: UnsafeMutablePointer<MIDIPacketList>
+
+    init() {
+        packetList = UnsafeMutableRawPointer.allocate(byteCount: MTCOutput.packetListSize, alignment: MemoryLayout<MIDIPacketList>.alignment).bindMemory(to: MIDIPacketList.self, capacity: 1)
+        timer = DispatchSource.makeTimerSource(flags: .strict, queue: queue)
+        timer.schedule(deadline: .now(), repeating: MTCOutput.batchInterval, leeway: .milliseconds(2))
+        MIDIClientCreateWithBlock("Timecode Display Output" as CFString, &client, nil)
+        MIDIOutputPortCreate(client, "Timecode Output" as CFString, &port)
+        timer.setEventHandler { [weak self] in
+            self?.sendBatch()
+        }
+    }
+
+    deinit {
+        if !timerRunning {
+            timer.resume() // A suspended timer can't be released
+        }
+        timer.cancel()
+        packetList.deallocate()
+    }
+
+    /// Starts sending to the destination with `uniqueID`, or stops if it's nil or can't be found.
+    func send(toDestinationID uniqueID: Int32?) {
+        var object = MIDIObjectRef()
+        var type = MIDIObjectType.other
+        var endpoint = MIDIEndpointRef()
+        if let uniqueID, MIDIObjectFindByUniqueID(uniqueID, &object, &type) == noErr, type == .destination {
+            endpoint = object
+        }
+        destinationID = endpoint != 0 ? uniqueID : nil
+
+        queue.sync {
+            destination = endpoint
+            generator.reset()
+            frames.drain { _ in } // Whatever was queued while we weren't sending is stale
+        }
+        if destinationID != nil && !timerRunning {
+            timerRunning = true
+            timer.resume()
+        } else if destinationID == nil && timerRunning {
+            timerRunning = false
+            timer.suspend()
+        }
+    }
+
+    // Output queue
+    private func sendBatch() {
+        frames.drain { entry in
+            generator.takeFrame(entry.timecode, atNanos: entry.nanos, isSysEx: entry.isSysEx)
+        }
+        guard destination != 0 && generator.isRunning else {
+            return
+        }
+
+        let now = SMConvertHostTimeToNanos(SMGetCurrentHostTime())
+        var packet = MIDIPacketListInit(packetList)
+        generator.generateBatches(atNanos: now, through: now + MTCOutput.lookahead, add: { bytes, nanos in
+            guard let next = SMWorkaroundMIDIPacketListAdd(packetList, ByteCount(MTCOutput.packetListSize), packet, SMConvertNanosToHostTime(nanos), ByteCount(bytes.count), bytes.baseAddress!) else {
+                return false
+            }
+            packet = next
+            return true
+        }, send: {
+            MIDISend(port, destination, packetList)
+            packet = MIDIPacketListInit(packetList)
+        })
+    }
+}
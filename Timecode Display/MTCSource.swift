@@ -0,0 +1,258 @@
+//
+//  MTCSource.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+#if canImport(TCDAtomics)
+import TCDAtomics // Built as a package; the app gets it from the bridging header
+#endif
+
+/// A lock-free single-producer, single-consumer queue of decoded frames.
+///
+/// The MIDI thread pushes; the main thread drains. Neither side ever waits on the other.
+final class FrameRing {
+    struct Entry {
+        var timecode: F53Timecode
+        var nanos: UInt64
+        var isSysEx: Bool // From a full-frame or MMC Locate message, so showing at `nanos` rather than before it
+    }
+
+    let capacity: UInt64
+    private let entries: UnsafeMutablePointer<Entry>
+    private let head: UnsafeMutablePointer<UInt64> // Next entry to write; only the producer changes it
+    private let tail: UnsafeMutablePointer<UInt64> // Next entry to read; only the consumer changes it
+
+    /// `capacity` must be a power of two.
+    init(capacity: Int) {
+        precondition(capacity > 0 && capacity & (capacity - 1) == 0)
+        self.capacity = UInt64(capacity)
+        entries = UnsafeMutablePointer<Entry>.allocate(capacity: capacity)
+        head = UnsafeMutablePointer<UInt64>.allocate(capacity: 1)
+        head.initialize(to: 0)
+        tail = UnsafeMutablePointer<UInt64>.allocate(capacity: 1)
+        tail.initialize(to: 0)
+    }
+
+    deinit {
+        entries.deallocate()
+        head.deallocate()
+        tail.deallocate()
+    }
+
+    /// Producer only. Returns false, dropping the frame, if the consumer is a whole ring behind.
+    @discardableResult
+    func push(_ timecode: F53Timecode, atNanos nanos: UInt64, isSysEx: Bool = false) -> Bool {
+        let writeIndex = TCDAtomicLoadRelaxed(head)
+        if writeIndex - TCDAtomicLoadAcquire(tail) >= capacity {
+            return false
+        }
+        (entries + Int(writeIndex & (capacity - 1))).initialize(to: Entry(timecode: timecode, nanos: nanos, isSysEx: isSysEx))
+        TCDAtomicStoreRelease(head, writeIndex + 1)
+        return true
+    }
+
+    /// Consumer only.
+    var isEmpty: Bool {
+        return TCDAtomicLoadAcquire(head) == TCDAtomicLoadRelaxed(tail)
+    }
+
+    /// Consumer only. Calls `body` with every entry pushed since the last drain, oldest first.
+    func drain(_ body: (Entry) -> Void) {
+        let readIndex = TCDAtomicLoadRelaxed(tail)
+        let writeIndex = TCDAtomicLoadAcquire(head)
+        var index = readIndex
+        while index != writeIndex {
+            body(entries[Int(index & (capacity - 1))])
+            index += 1
+        }
+        TCDAtomicStoreRelease(tail, writeIndex)
+    }
+}
+
+/// The handshake that lets the consumer of several sources' rings sleep until one of them has
+/// frames for it, without the producers waking it for every frame.
+///
+/// The consumer calls `wakeOnNextFrame` when it's caught up; producers call `framesQueued`
+/// after pushing. Exactly one of those calls returns true for each request, and whoever gets it
+/// wakes the consumer.
+final class FrameWakeup {
+    // Set to 1 by the consumer when it wants to hear about the next frame; cleared by whichever
+    // call claims the wakeup. It starts set, so the first frame wakes the consumer.
+    private let requested: UnsafeMutablePointer<UInt64>
+
+    // The only source whose frames can claim the wakeup, from `filterValue(for:)`, or 0 for any.
+    // A source the selection would never follow would otherwise wake the consumer for every packet.
+    private let filter: UnsafeMutablePointer<UInt64>
+
+    init() {
+        requested = UnsafeMutablePointer<UInt64>.allocate(capacity: 1)
+        requested.initialize(to: 1)
+        filter = UnsafeMutablePointer<UInt64>.allocate(capacity: 1)
+        filter.initialize(to: 0)
+    }
+
+    deinit {
+        requested.deallocate()
+        filter.deallocate()
+    }
+
+    /// Consumer only. Only frames from the source `selection` could follow will wake it from now on.
+    func follow(_ selection: SourceSelection) {
+        if case .only(let uniqueID) = selection {
+            TCDAtomicStoreRelease(filter, FrameWakeup.filterValue(for: uniqueID))
+        } else {
+            TCDAtomicStoreRelease(filter, 0)
+        }
+    }
+
+    /// Consumer only. Asks to be woken once the next frame arrives. Returns true if one already
+    /// has since the last drain, in which case nobody else will wake it.
+    func wakeOnNextFrame(_ sources: [MTCSource]) -> Bool {
+        // An exchange, not a store, so it's ordered against the producer's: either a frame pushed
+        // before this saw the flag set and claimed the wakeup, or we see the frame here. Otherwise
+        // one pushed just after the last drain would sit there until the next one came along.
+        _ = TCDAtomicExchange(requested, 1)
+        return sources.contains { canWake($0) && !$0.frames.isEmpty } && claim()
+    }
+
+    /// Producer only. Called after pushing frames into `source`. Returns true if the caller
+    /// should wake the consumer.
+    func framesQueued(from source: MTCSource) -> Bool {
+        return canWake(source) && claim()
+    }
+
+    private static func filterValue(for uniqueID: Int32) -> UInt64 {
+        return 1 << 32 | UInt64(UInt32(bitPattern: uniqueID))
+    }
+
+    private func canWake(_ source: MTCSource) -> Bool {
+        let value = TCDAtomicLoadAcquire(filter)
+        return value == 0 || value == FrameWakeup.filterValue(for: source.uniqueID)
+    }
+
+    private func claim() -> Bool {
+        return TCDAtomicExchange(requested, 0) != 0
+    }
+}
+
+/// What a source sends. LTC can be shuttled much slower than MTC runs, and the log says which it was.
+enum TimecodeKind: UInt16 {
+    case mtc = 0
+    case ltc = 1
+
+    var name: String {
+        switch self {
+        case .mtc:
+            return "MTC"
+        case .ltc:
+            return "LTC"
+        }
+    }
+}
+
+/// One device sending us timecode, with its own decoder so several sources can't corrupt each
+/// other's frames.
+///
+/// `take` runs on the MIDI thread and is the only thing that touches the decoder. Everything
+/// else runs on the main thread; the two sides only meet in `frames` and the reset flag.
+final class MTCSource {
+    let uniqueID: Int32
+    let name: String
+    let kind: TimecodeKind
+    let frames = FrameRing(capacity: 64)
+
+    private var decoder = MTCDecoder()
+    private let resetRequested: UnsafeMutablePointer<UInt64>
+
+    // Main thread only
+    fileprivate var lastFrameNanos: UInt64 = 0
+
+    init(uniqueID: Int32, name: String, kind: TimecodeKind = .mtc) {
+        self.uniqueID = uniqueID
+        self.name = name
+        self.kind = kind
+        resetRequested = UnsafeMutablePointer<UInt64>.allocate(capacity: 1)
+        resetRequested.initialize(to: 0)
+    }
+
+    deinit {
+        resetRequested.deallocate()
+    }
+
+    /// MIDI thread. Runs `bytes` through this source's decoder and queues any frames it completes.
+    /// Returns true if it queued any.
+    func take(_ bytes: UnsafeBufferPointer<UInt8>, atNanos nanos: UInt64) -> Bool {
+        if TCDAtomicExchange(resetRequested, 0) != 0 {
+            decoder.reset()
+        }
+        var queued = false
+        decoder.decode(bytes) { timecode, isSysEx in
+            if frames.push(timecode, atNanos: nanos, isSysEx: isSysEx) {
+                queued = true
+            }
+        }
+        return queued
+    }
+
+    /// Main thread. The decoder starts over before it reads any more bytes.
+    func requestReset() {
+        TCDAtomicStoreRelease(resetRequested, 1)
+    }
+}
+
+/// Which source's timecode to follow when more than one is sending.
+enum SourceSelection: Equatable {
+    /// Stay with whichever source started first, until it stops
+    case firstActive
+    /// Follow the active source that comes first in the source list
+    case priority
+    /// Follow only the source with this unique ID
+    case only(Int32)
+}
+
+/// Picks one source to follow, on the main thread, each time frames are drained.
+struct SourceArbiter {
+    /// A source that has sent a frame within this long (ns) counts as active.
+    static let activeInterval: UInt64 = 200_000_000
+
+    var selection: SourceSelection = .firstActive
+    private(set) var currentSourceID: Int32?
+
+    /// Drains every source, so none of them back up, and passes on the frames of the one
+    /// `selection` picks, with that source. `sources` is in priority order.
+    mutating func drain(_ sources: [MTCSource], atNanos now: UInt64, frameReceived: (FrameRing.Entry, MTCSource) -> Void) {
+        let chosen = choose(sources, atNanos: now)
+        currentSourceID = chosen?.uniqueID
+
+        for source in sources {
+            let isChosen = source === chosen
+            source.frames.drain { entry in
+                source.lastFrameNanos = max(source.lastFrameNanos, entry.nanos)
+                if isChosen {
+                    frameReceived(entry, source)
+                }
+            }
+        }
+    }
+
+    private func choose(_ sources: [MTCSource], atNanos now: UInt64) -> MTCSource? {
+        func isActive(_ source: MTCSource) -> Bool {
+            return !source.frames.isEmpty || now < source.lastFrameNanos + SourceArbiter.activeInterval
+        }
+
+        switch selection {
+        case .only(let uniqueID):
+            return sources.first { $0.uniqueID == uniqueID }
+        case .firstActive:
+            if let current = sources.first(where: { $0.uniqueID == currentSourceID }), isActive(current) {
+                return current
+            }
+            return sources.first(where: isActive)
+        case .priority:
+            return sources.first(where: isActive)
+        }
+    }
+}
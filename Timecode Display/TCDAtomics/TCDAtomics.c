@@ -0,0 +1,11 @@
+//
+//  TCDAtomics.c
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+//  Everything in TCDAtomics.h is inline. This only exists so Swift Package Manager has a C
+//  target to export the header from; the app imports it through the bridging header instead.
+//
+
+#include "TCDAtomics.h"
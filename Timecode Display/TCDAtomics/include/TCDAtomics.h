@@ -0,0 +1,42 @@
+//
+//  TCDAtomics.h
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+#ifndef TCDAtomics_h
+#define TCDAtomics_h
+
+#include <stdint.h>
+
+// Swift has no atomics of its own on the systems we support, so the lock-free handoff from the
+// MIDI thread to the main thread goes through these. They operate on plain uint64_t storage that
+// must only ever be accessed through them.
+
+static inline uint64_t TCDAtomicLoadRelaxed(const uint64_t *value) {
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t TCDAtomicLoadAcquire(const uint64_t *value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void TCDAtomicStoreRelease(uint64_t *value, uint64_t newValue) {
+    __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+static inline uint64_t TCDAtomicExchange(uint64_t *value, uint64_t newValue) {
+    return __atomic_exchange_n(value, newValue, __ATOMIC_ACQ_REL);
+}
+
+// Return the value from before the change.
+static inline uint64_t TCDAtomicAdd(uint64_t *value, uint64_t delta) {
+    return __atomic_fetch_add(value, delta, __ATOMIC_ACQ_REL);
+}
+
+static inline uint64_t TCDAtomicSubtract(uint64_t *value, uint64_t delta) {
+    return __atomic_fetch_sub(value, delta, __ATOMIC_ACQ_REL);
+}
+
+#endif /* TCDAtomics_h */
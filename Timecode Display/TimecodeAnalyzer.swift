@@ -6,41 +6,70 @@
 //
 
 import AppKit
+import SnoizeMIDI
 
 class TimecodeAnalyzer: MIDIReceiverDelegate {
-    private var timeLastFrameReceived: TimeInterval?
-    private var lastReceivedTimecode: F53Timecode?
-    private var freewheelTimer: Timer?
-    
-    func midiReceiver(_ sender: MIDIReceiver, didReceive timecode: F53Timecode) {
-        let now = NSDate.timeIntervalSinceReferenceDate
-        let timecodeString = timecode.stringRepresentation
-        let framerateString = timecode.framerate.speedAgnosticDescription
+    private static let refreshInterval = DispatchTimeInterval.nanoseconds(1_000_000_000 / 120)
+
+    private weak var receiver: MIDIReceiver?
+    private var tracker = TimecodeTracker()
+
+    // One timer collects frames from the receiver, drives the display between frames, and notices
+    // when frames stop coming. It runs only while timecode is running, and is never rescheduled per frame.
+    private var watchdogRunning = false
+    private lazy var watchdog: DispatchSourceTimer = {
+        let timer = DispatchSource.makeTimerSource(queue: .main)
+        timer.schedule(deadline: .now(), repeating: TimecodeAnalyzer.refreshInterval, leeway: .milliseconds(1))
+        timer.setEventHandler { [weak self] in
+            self?.refresh()
+        }
+        return timer
+    }()
+
+    func midiReceiverHasFrames(_ sender: MIDIReceiver) {
+        receiver = sender
+        if !watchdogRunning {
+            watchdogRunning = true
+            watchdog.resume()
+        }
+        refresh()
+    }
+
+    private func refresh() {
         let appDelegate = NSApp.delegate as! AppDelegate
+        let now = SMConvertHostTimeToNanos(SMGetCurrentHostTime())
+        let time = Date.timeIntervalSinceReferenceDate
 
-        // Test for new starts or discontinuities
-        if timeLastFrameReceived == nil || now - timeLastFrameReceived! > 0.1 {
-            // It's been long enough that this is a new start.
-            appDelegate.appendLog("MTC start at \(timecodeString) - \(framerateString)")
-        } else {
-            if let lastReceivedTimecode, timecode.framesFromZero != lastReceivedTimecode.framesFromZero + 1 {
-                appDelegate.appendLog("MTC discontinuity - from \(lastReceivedTimecode.stringRepresentation) to \(timecodeString)")
-            }
+        let output = appDelegate.mtcOutput.destinationID != nil ? appDelegate.mtcOutput : nil
+        receiver?.takeFrames { entry, source in
+            tracker.takeFrame(entry.timecode, atNanos: entry.nanos, isSysEx: entry.isSysEx, kind: source.kind, time: time, log: appDelegate.appendLog)
+            output?.frames.push(entry.timecode, atNanos: entry.nanos, isSysEx: entry.isSysEx)
         }
-        
-        // Show in timecode window
-        appDelegate.timecodeView.stringValue = timecode.stringRepresentation
-        
-        // Freewheel
-        freewheelTimer?.invalidate()
-        freewheelTimer = Timer.scheduledTimer(withTimeInterval: 0.2, repeats: false, block: { timer in
-            appDelegate.appendLog("MTC stop at \(timecodeString)")
-            self.timeLastFrameReceived = nil
-            self.lastReceivedTimecode = nil
+        guard tracker.isRunning else {
+            // Woken by a source we're not following
+            stop()
+            return
+        }
+
+        let lastReceivedTimecode = tracker.lastReceivedTimecode // The stop resets the tracker
+        if tracker.checkForStop(atNanos: now, time: time, log: appDelegate.appendLog) {
+            // Leave the last frame received showing, not wherever the clock had freewheeled to
+            appDelegate.timecodeView.timecode = lastReceivedTimecode
+            stop()
             appDelegate.reserReceiver()
-        })
-        
-        lastReceivedTimecode = timecode
-        timeLastFrameReceived = now
+            return
+        }
+
+        // Show in timecode window
+        appDelegate.timecodeView.timecode = tracker.timecode(atNanos: now)
+    }
+
+    private func stop() {
+        if watchdogRunning {
+            watchdogRunning = false
+            watchdog.suspend()
+        }
+        receiver?.wakeOnNextFrame()
+        tracker.reset()
     }
 }
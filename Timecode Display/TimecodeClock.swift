@@ -0,0 +1,137 @@
+//
+//  TimecodeClock.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+
+/// Recovers a continuous timecode clock from frames stamped with the host time they arrived.
+///
+/// Each frame nudges a phase-and-rate estimate (a second-order PLL, in the form of an alpha-beta
+/// filter), so the clock can say where timecode is at any moment in between frames, and keep
+/// going at the estimated rate for a while when frames stop arriving. All times are in host
+/// nanoseconds, as returned by `SMConvertHostTimeToNanos`, but nothing here depends on CoreMIDI.
+struct TimecodeClock {
+    /// How far behind real time a frame decoded from quarter frames is, in frames.
+    /// An MTC message takes two frames to send. `MTCDecoder` already reports it twice, once
+    /// after its first four pieces and once (plus a frame) after its last four, so each report
+    /// arrives three quarters of a frame after the frame it names began. Full-frame and MMC
+    /// Locate messages name the frame that's showing as they arrive, so they're taken as is.
+    static let reportLatencyFrames = 0.75
+
+    /// An error this large, in frames, is treated as a jump rather than jitter.
+    static let discontinuityThreshold = 2.0
+
+    /// Filter gains. Alpha corrects phase, beta corrects rate; they're large for the first few
+    /// frames so the clock locks quickly, then settle to these values.
+    static let alpha = 0.1
+    static let beta = 0.005
+
+    struct Statistics {
+        /// Frames used since the clock last locked
+        var sampleCount = 0
+        /// Root-mean-square of the difference between predicted and reported arrival, in seconds
+        var rmsJitter = 0.0
+        /// Largest difference between predicted and reported arrival, in seconds
+        var maxJitter = 0.0
+        /// How far the estimated rate is from the nominal frame rate, in parts per million
+        var driftPPM = 0.0
+
+        fileprivate var sumOfSquares = 0.0
+    }
+
+    private(set) var framerate: F53Timecode.Framerate?
+    private(set) var statistics = Statistics()
+
+    private var referenceNanos: UInt64 = 0
+    private var referencePosition = 0.0 // Frames from zero at referenceNanos
+    private var rate = 0.0 // Frames per second
+
+    var isLocked: Bool {
+        return framerate != nil
+    }
+
+    /// Estimated frames per second; negative if timecode is going backwards
+    var estimatedFPS: Double {
+        return rate
+    }
+
+    mutating func reset() {
+        self = TimecodeClock()
+    }
+
+    /// Feeds the clock a frame reported at `nanos`, by quarter frames or, if `isSysEx`, by a
+    /// full-frame or MMC Locate message. Returns false if it didn't follow on from the previous
+    /// frames and the clock had to relock to it.
+    @discardableResult
+    mutating func takeFrame(_ timecode: F53Timecode, atNanos nanos: UInt64, isSysEx: Bool = false) -> Bool {
+        let observed = Double(timecode.framesFromZero) + (isSysEx ? 0 : TimecodeClock.reportLatencyFrames)
+
+        guard let framerate, framerate == timecode.framerate, nanos >= referenceNanos else {
+            lock(to: observed, framerate: timecode.framerate, atNanos: nanos)
+            return false
+        }
+
+        let elapsed = Double(nanos - referenceNanos) / 1e9
+        let predicted = referencePosition + rate * elapsed
+        let error = observed - predicted
+        // Until a second frame arrives the rate is only assumed, so that one is judged by how far
+        // it is from the first, not from where the assumed rate would put it: LTC can be going
+        // backwards, or far slower than normal. Its error then sets the rate outright.
+        let isFirstStep = statistics.sampleCount == 0
+        if abs(isFirstStep ? observed - referencePosition : error) > TimecodeClock.discontinuityThreshold {
+            lock(to: observed, framerate: framerate, atNanos: nanos)
+            return false
+        }
+
+        statistics.sampleCount += 1
+        let n = Double(statistics.sampleCount)
+        let alpha = max(TimecodeClock.alpha, 1.0 / n)
+        let beta = max(TimecodeClock.beta, 1.0 / (n * n))
+
+        referencePosition = predicted + alpha * error
+        if elapsed > 0 {
+            rate += beta * error / elapsed
+        }
+        referenceNanos = nanos
+
+        // The first step's error only says how wrong the assumed rate was, so it isn't jitter.
+        if !isFirstStep && rate != 0 {
+            let jitter = abs(error / rate)
+            statistics.sumOfSquares += jitter * jitter
+            statistics.rmsJitter = (statistics.sumOfSquares / (n - 1)).squareRoot()
+            statistics.maxJitter = max(statistics.maxJitter, jitter)
+        }
+        statistics.driftPPM = (abs(rate) / framerate.nominalFPS - 1.0) * 1e6
+        return true
+    }
+
+    /// Where the clock thinks timecode is at `nanos`, in frames from zero, including the fraction
+    /// of the current frame.
+    func position(atNanos nanos: UInt64) -> Double? {
+        guard isLocked else {
+            return nil
+        }
+        let elapsed = nanos >= referenceNanos ? Double(nanos - referenceNanos) / 1e9 : -(Double(referenceNanos - nanos) / 1e9)
+        return referencePosition + rate * elapsed
+    }
+
+    /// The frame the clock thinks is showing at `nanos`, once a second frame has followed on from
+    /// the one it locked to. Until then its rate is only the nominal one, so it isn't worth showing.
+    func timecode(atNanos nanos: UInt64) -> F53Timecode? {
+        guard let framerate, statistics.sampleCount > 0, let position = position(atNanos: nanos), position >= 0 else {
+            return nil
+        }
+        return F53Timecode(framerate: framerate, framesFromZero: UInt(position))
+    }
+
+    private mutating func lock(to position: Double, framerate: F53Timecode.Framerate, atNanos nanos: UInt64) {
+        self.framerate = framerate
+        referenceNanos = nanos
+        referencePosition = position
+        rate = framerate.nominalFPS
+        statistics = Statistics()
+    }
+}
@@ -0,0 +1,116 @@
+//
+//  TimecodeRaster.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+
+/// The ten digits and two separators a timecode is drawn with, rasterized once into 8-bit
+/// coverage cells. Digits all share one cell width (the font's monospaced digit advance), and
+/// separators share another.
+struct GlyphAtlas {
+    static let characters = Array("0123456789:;".utf8)
+
+    let digitWidth: Int
+    let separatorWidth: Int
+    let height: Int
+    private let offsets: [Int]
+    private(set) var pixels: [UInt8]
+
+    /// `rasterize` draws one character into a zeroed, top-row-first cell of the given width and height.
+    init(digitWidth: Int, separatorWidth: Int, height: Int, rasterize: (UInt8, UnsafeMutableBufferPointer<UInt8>, Int, Int) -> Void) {
+        self.digitWidth = digitWidth
+        self.separatorWidth = separatorWidth
+        self.height = height
+
+        var offsets: [Int] = []
+        var total = 0
+        for character in GlyphAtlas.characters {
+            offsets.append(total)
+            total += GlyphAtlas.isDigit(character) ? digitWidth * height : separatorWidth * height
+        }
+        self.offsets = offsets
+        self.pixels = [UInt8](repeating: 0, count: total)
+
+        pixels.withUnsafeMutableBufferPointer { buffer in
+            for (index, character) in GlyphAtlas.characters.enumerated() {
+                let width = GlyphAtlas.isDigit(character) ? digitWidth : separatorWidth
+                let cell = UnsafeMutableBufferPointer(rebasing: buffer[offsets[index] ..< offsets[index] + width * height])
+                rasterize(character, cell, width, height)
+            }
+        }
+    }
+
+    static func isDigit(_ character: UInt8) -> Bool {
+        return character >= UInt8(ascii: "0") && character <= UInt8(ascii: "9")
+    }
+
+    func width(of character: UInt8) -> Int {
+        return GlyphAtlas.isDigit(character) ? digitWidth : separatorWidth
+    }
+
+    /// Offset of a character's cell in `pixels`.
+    func offset(of character: UInt8) -> Int {
+        if GlyphAtlas.isDigit(character) {
+            return offsets[Int(character - UInt8(ascii: "0"))]
+        }
+        return offsets[character == UInt8(ascii: ";") ? 11 : 10]
+    }
+}
+
+/// The layout of a timecode drawn from a GlyphAtlas as HH:MM:SS:FF, and which character each
+/// cell is showing.
+///
+/// `update` compares the new timecode against what the cells already show, so the caller can
+/// redraw only the columns that changed, which on a typical frame is just one or two digits.
+/// Platform code draws each cell straight from the atlas using `cell(_:)`; nothing here depends
+/// on AppKit.
+final class TimecodeRaster {
+    static let cellCount = F53Timecode.formattedLength
+
+    let atlas: GlyphAtlas
+    let width: Int
+    let height: Int
+
+    private let cellX: [Int]
+    private var shown = [UInt8](repeating: 0, count: TimecodeRaster.cellCount) // 0 until a cell is first drawn
+    private var next = [UInt8](repeating: 0, count: TimecodeRaster.cellCount)
+
+    init(atlas: GlyphAtlas) {
+        self.atlas = atlas
+        var cellX: [Int] = []
+        var x = 0
+        for cell in 0..<TimecodeRaster.cellCount {
+            cellX.append(x)
+            x += cell % 3 == 2 ? atlas.separatorWidth : atlas.digitWidth
+        }
+        self.cellX = cellX
+        self.width = x
+        self.height = atlas.height
+    }
+
+    /// Makes the cells show `timecode`. Returns the range of pixel columns that changed, or nil
+    /// if they already showed it.
+    @discardableResult
+    func update(_ timecode: F53Timecode) -> Range<Int>? {
+        next.withUnsafeMutableBufferPointer { buffer in
+            _ = timecode.write(into: buffer)
+        }
+
+        var dirty: Range<Int>?
+        for cell in 0..<TimecodeRaster.cellCount where next[cell] != shown[cell] {
+            shown[cell] = next[cell]
+            let x = cellX[cell]
+            let columns = x ..< x + atlas.width(of: next[cell])
+            dirty = dirty.map { min($0.lowerBound, columns.lowerBound) ..< max($0.upperBound, columns.upperBound) } ?? columns
+        }
+        return dirty
+    }
+
+    /// The character cell `index` shows, or 0 if it hasn't been drawn yet, and the pixel column it starts at.
+    func cell(_ index: Int) -> (character: UInt8, x: Int) {
+        return (shown[index], cellX[index])
+    }
+}
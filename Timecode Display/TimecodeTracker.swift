@@ -0,0 +1,99 @@
+//
+//  TimecodeTracker.swift
+//  Timecode Display
+//
+//  Created on 10/17/26.
+//
+
+import Foundation
+
+/// Follows a stream of frames from one source and turns it into start, discontinuity and stop
+/// events, keeping a `TimecodeClock` locked to it along the way.
+///
+/// It doesn't keep time itself: callers say what time it is, so the same logic runs live in the
+/// app and against a replayed capture.
+struct TimecodeTracker {
+    static let newStartInterval: UInt64 = 100_000_000 // A gap longer than this (ns) starts over
+    static let dropoutInterval: UInt64 = 200_000_000 // Freewheel this long (ns) before calling it a stop
+    /// At slow varispeed frames can be further apart than those, so they stretch to this many frame
+    /// periods at the rate the clock has measured. Until it's measured one, MTC frames are taken
+    /// to be at their nominal rate, and LTC frames, which can be shuttled much slower, to be
+    /// `slowestFramePeriod` (ns) apart; nothing is taken to be slower than that.
+    static let newStartFrames = 1.5
+    static let dropoutFrames = 2.5
+    static let slowestFramePeriod = 600_000_000.0 // A little slower than LTCDecoder follows
+    /// The longest a stop can take to notice.
+    static let longestDropoutInterval = max(dropoutInterval, UInt64(dropoutFrames * slowestFramePeriod))
+
+    private(set) var clock = TimecodeClock()
+    private(set) var lastReceivedTimecode: F53Timecode?
+    private(set) var timeLastFrameReceived: UInt64?
+    private(set) var kind = TimecodeKind.mtc // Of the source the last frame came from
+
+    var isRunning: Bool {
+        return timeLastFrameReceived != nil
+    }
+
+    /// `nanos` is when the frame arrived, in host nanoseconds; `time` is the same moment in seconds
+    /// since the reference date, for the log. `isSysEx` is as in `TimecodeClock.takeFrame`.
+    mutating func takeFrame(_ timecode: F53Timecode, atNanos nanos: UInt64, isSysEx: Bool = false, kind: TimecodeKind = .mtc, time: Double, log: (EventRecord) -> Void) {
+        self.kind = kind
+        // Test for new starts or discontinuities
+        if timeLastFrameReceived == nil || nanos > timeLastFrameReceived! + interval(TimecodeTracker.newStartInterval, frames: TimecodeTracker.newStartFrames) {
+            // It's been long enough that this is a new start.
+            log(.start(timecode, source: kind, time: time))
+        } else {
+            if let lastReceivedTimecode, !follows(lastReceivedTimecode, with: timecode) {
+                log(.discontinuity(from: lastReceivedTimecode, to: timecode, source: kind, time: time))
+            }
+        }
+
+        clock.takeFrame(timecode, atNanos: nanos, isSysEx: isSysEx)
+        lastReceivedTimecode = timecode
+        timeLastFrameReceived = nanos
+    }
+
+    /// Logs a stop and starts over if no frame has arrived for `dropoutInterval`, or `dropoutFrames`
+    /// at a slow rate, before `now`. Returns true if it did.
+    @discardableResult
+    mutating func checkForStop(atNanos now: UInt64, time: Double, log: (EventRecord) -> Void) -> Bool {
+        guard let timeLastFrameReceived, let lastReceivedTimecode, now > timeLastFrameReceived + interval(TimecodeTracker.dropoutInterval, frames: TimecodeTracker.dropoutFrames) else {
+            return false
+        }
+        log(.stop(lastReceivedTimecode, statistics: clock.statistics, source: kind, time: time))
+        reset()
+        return true
+    }
+
+    /// What to show at `now`: the clock's estimate, freewheeling at the recovered rate between
+    /// frames, or until it has two frames to go on, the last frame received.
+    func timecode(atNanos now: UInt64) -> F53Timecode? {
+        return clock.timecode(atNanos: now) ?? lastReceivedTimecode
+    }
+
+    mutating func reset() {
+        self = TimecodeTracker()
+    }
+
+    // `minimum`, or `frames` frame periods if that's longer.
+    private func interval(_ minimum: UInt64, frames: Double) -> UInt64 {
+        var period = TimecodeTracker.slowestFramePeriod
+        if clock.statistics.sampleCount > 0 && clock.estimatedFPS != 0 {
+            period = min(1e9 / abs(clock.estimatedFPS), period)
+        } else if kind == .mtc, let lastReceivedTimecode {
+            // A lone MMC Locate, or the first frame of a run, shouldn't hold a stop off for 1.5 s.
+            period = 1e9 / lastReceivedTimecode.framerate.nominalFPS
+        }
+        return max(minimum, UInt64(frames * period))
+    }
+
+    // True if `timecode` is the frame after `previous` in the direction the clock is going, which
+    // for LTC can be backwards. Until the clock has measured its rate, either direction will do.
+    private func follows(_ previous: F53Timecode, with timecode: F53Timecode) -> Bool {
+        let frames = timecode.framesFromZero
+        if clock.statistics.sampleCount == 0 {
+            return frames == previous.adding(frames: 1).framesFromZero || frames == previous.adding(frames: -1).framesFromZero
+        }
+        return frames == previous.adding(frames: clock.estimatedFPS < 0 ? -1 : 1).framesFromZero
+    }
+}
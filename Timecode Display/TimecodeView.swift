@@ -8,31 +8,125 @@
 import AppKit
 
 class TimecodeView: NSView {
-    var stringValue: String? {
+    var timecode: F53Timecode? {
         didSet {
-            self.needsDisplay = true
+            guard let timecode, let raster = prepareRaster() else {
+                self.needsDisplay = true
+                return
+            }
+            if let columns = raster.update(timecode) {
+                let rect = textRect
+                let scale = rasterScale
+                self.setNeedsDisplay(NSRect(x: rect.minX + CGFloat(columns.lowerBound) / scale, y: rect.minY, width: CGFloat(columns.count) / scale, height: rect.height).insetBy(dx: -1, dy: -1))
+            }
         }
     }
-    
+
+    private static let textColor = NSColor(white: 1.0, alpha: 0.9).cgColor
+
+    // Everything below is rebuilt only when the font size in pixels changes.
+    private var raster: TimecodeRaster?
+    private var glyphs: [UInt8: CGImage] = [:] // A mask for each of the atlas's characters
+    private var rasterPixelSize: CGFloat = 0
+    private var rasterScale: CGFloat = 1
+    private var rasterDescent: CGFloat = 0 // Pixels from the bottom of the raster to the baseline
+    private var rasterLineHeight: CGFloat = 0 // Pixels
+
+    override func viewDidChangeBackingProperties() {
+        super.viewDidChangeBackingProperties()
+        self.needsDisplay = true
+    }
+
     override func draw(_ dirtyRect: NSRect) {
-        guard let stringValue,
+        guard let timecode,
+              let raster = prepareRaster(),
               let ctx = NSGraphicsContext.current?.cgContext
         else {
             return
         }
-        
-        let size = min(1.0 * self.frame.height, 0.15 * self.frame.width)
-        
+
+        raster.update(timecode)
+
+        // Each cell is drawn straight from its glyph's mask, which was made once with the raster,
+        // and only if it's in the dirty rect, so a new frame redraws just the digits that changed.
+        let rect = textRect
+        for index in 0..<TimecodeRaster.cellCount {
+            let cell = raster.cell(index)
+            guard let glyph = glyphs[cell.character] else {
+                continue
+            }
+            let cellRect = NSRect(x: rect.minX + CGFloat(cell.x) / rasterScale, y: rect.minY, width: CGFloat(glyph.width) / rasterScale, height: rect.height)
+            guard cellRect.intersects(dirtyRect) else {
+                continue
+            }
+            ctx.saveGState()
+            ctx.clip(to: cellRect, mask: glyph)
+            ctx.setFillColor(TimecodeView.textColor)
+            ctx.fill(cellRect.intersection(dirtyRect))
+            ctx.restoreGState()
+        }
+    }
+
+    private var textRect: NSRect {
+        guard let raster else {
+            return .zero
+        }
+        let width = CGFloat(raster.width) / rasterScale
+        let height = CGFloat(raster.height) / rasterScale
+        let baseline = 0.65 * self.frame.height - 0.5 * rasterLineHeight / rasterScale
+        return NSRect(x: 0.5 * (self.frame.width - width), y: baseline - rasterDescent / rasterScale, width: width, height: height)
+    }
+
+    private func prepareRaster() -> TimecodeRaster? {
+        let scale = self.window?.backingScaleFactor ?? 1.0
+        let pixelSize = (min(1.0 * self.frame.height, 0.15 * self.frame.width) * scale).rounded()
+        if let raster, pixelSize == rasterPixelSize, scale == rasterScale {
+            return raster
+        }
+
+        raster = nil
+        glyphs = [:]
+        rasterPixelSize = pixelSize
+        rasterScale = scale
+        guard pixelSize >= 1 else {
+            return nil
+        }
+
+        let font = NSFont.monospacedDigitSystemFont(ofSize: pixelSize, weight: .regular)
         let attributes: [NSAttributedString.Key: Any] = [
-            .font: NSFont.monospacedDigitSystemFont(ofSize: size, weight: .regular),
-            .foregroundColor: NSColor(white: 1.0, alpha: 0.9)
+            .font: font,
+            .foregroundColor: NSColor.white
         ]
-        let attributedString = NSAttributedString(string: stringValue, attributes: attributes)
-        let line = CTLineCreateWithAttributedString(attributedString)
-        ctx.saveGState()
-        ctx.textMatrix = .identity
-        ctx.textPosition = CGPoint(x: 0.5 * (self.frame.width - attributedString.size().width), y: 0.65 * self.frame.height - 0.5 * attributedString.size().height)
-        CTLineDraw(line, ctx)
-        ctx.restoreGState()
+        func line(_ character: UInt8) -> CTLine {
+            return CTLineCreateWithAttributedString(NSAttributedString(string: String(UnicodeScalar(character)), attributes: attributes))
+        }
+
+        let descent = ceil(font.descender * -1)
+        let height = Int(ceil(font.ascender) + descent)
+        let digitWidth = Int(ceil(CTLineGetTypographicBounds(line(UInt8(ascii: "0")), nil, nil, nil)))
+        let separatorWidth = Int(ceil(CTLineGetTypographicBounds(line(UInt8(ascii: ":")), nil, nil, nil)))
+        rasterDescent = descent
+        rasterLineHeight = ceil(font.ascender - font.descender + font.leading)
+
+        let atlas = GlyphAtlas(digitWidth: digitWidth, separatorWidth: separatorWidth, height: height) { character, cell, width, height in
+            guard let bitmap = CGContext(data: cell.baseAddress, width: width, height: height, bitsPerComponent: 8, bytesPerRow: width, space: CGColorSpaceCreateDeviceGray(), bitmapInfo: CGImageAlphaInfo.none.rawValue) else {
+                return
+            }
+            bitmap.textMatrix = .identity
+            bitmap.textPosition = CGPoint(x: 0, y: descent)
+            CTLineDraw(line(character), bitmap)
+        }
+        for character in GlyphAtlas.characters {
+            let width = atlas.width(of: character)
+            let offset = atlas.offset(of: character)
+            guard let provider = CGDataProvider(data: Data(atlas.pixels[offset ..< offset + width * height]) as CFData) else {
+                continue
+            }
+            glyphs[character] = CGImage(width: width, height: height, bitsPerComponent: 8, bitsPerPixel: 8, bytesPerRow: width, space: CGColorSpaceCreateDeviceGray(), bitmapInfo: CGBitmapInfo(rawValue: CGImageAlphaInfo.none.rawValue), provider: provider, decode: nil, shouldInterpolate: false, intent: .defaultIntent)
+        }
+        let raster = TimecodeRaster(atlas: atlas)
+        self.raster = raster
+        self.needsDisplay = true
+        return raster
     }
 }
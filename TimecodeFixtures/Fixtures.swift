@@ -0,0 +1,34 @@
+//
+//  Fixtures.swift
+//  TimecodeFixtures
+//
+//  Created on 10/17/26.
+//
+//  Test data shared by the command-line tools, so each of them makes up MIDI the same way. Like
+//  the app's own types, these are internal, and the tools reach them with `@testable import`.
+//
+
+import Foundation
+@testable import TimecodeCore
+
+/// A small seeded generator, so a failing run can be repeated exactly.
+struct SplitMix64: RandomNumberGenerator {
+    var state: UInt64
+
+    mutating func next() -> UInt64 {
+        state &+= 0x9e37_79b9_7f4a_7c15
+        var z = state
+        z = (z ^ (z >> 30)) &* 0xbf58_476d_1ce4_e5b9
+        z = (z ^ (z >> 27)) &* 0x94d0_49bb_1331_11eb
+        return z ^ (z >> 31)
+    }
+}
+
+/// The eight quarter-frame messages that send `timecode`, starting on that frame, as (F1, data)
+/// pairs, made the same way MTCGenerator makes them.
+func quarterFrames(_ timecode: F53Timecode) -> [[UInt8]] {
+    let sequence = MTCGenerator.sequence(for: timecode)
+    return (UInt8(0)..<8).map { piece -> [UInt8] in
+        [0xf1, piece << 4 | MTCGenerator.quarterFrameNibble(piece, of: sequence)]
+    }
+}
@@ -0,0 +1,375 @@
+//
+//  main.swift
+//  tcdbench
+//
+//  Created on 10/17/26.
+//
+//  Measures the app's hot paths away from the app, printing one line per benchmark to stdout.
+//  Each runs for about a second after a warm-up pass, so numbers from different machines and
+//  builds can be compared directly.
+//
+//    tcdbench [<benchmark>...]
+//
+//  With no arguments it runs them all. `decoder` feeds MTC quarter frames mixed in with MIDI clock,
+//  notes and controllers through MTCDecoder, and reports MIDI messages per second; where SnoizeMIDI
+//  is available, it also feeds the same packets through SnoizeMIDI's message parser and picks the
+//  quarter frames out of the `Message` objects, as the app used to, for comparison. `timecode`
+//  times converting frame counts to timecodes and back, and writing them out as text. `raster`
+//  times TimecodeRaster working out which cells of a full-screen-sized display change with each new
+//  frame, and finding them again as the view draws. `eventlog` appends a million events to an
+//  EventLog with a journal in a temporary directory, and reports the peak memory use before and
+//  after, which should be the same. `replay` generates a three-hour capture and times
+//  CaptureReplayer running it through the app's decoding and tracking.
+//
+//  Apart from that comparison it doesn't need CoreMIDI or AppKit. To build and run it anywhere Swift
+//  runs, from the repository root:
+//
+//    swift run -c release tcdbench
+//
+
+import Foundation
+@testable import TimecodeCore
+@testable import TimecodeFixtures
+#if canImport(SnoizeMIDI)
+import CoreMIDI
+import SnoizeMIDI
+#endif
+
+/// Somewhere for results to go, so the optimizer can't drop the work that made them.
+var sink = 0
+
+@inline(never)
+func consume(_ value: Int) {
+    sink &+= value
+}
+
+/// Runs `body` once to warm up, then repeatedly for at least `seconds`. Returns seconds per run.
+func measure(seconds: Double = 1, _ body: () -> Void) -> Double {
+    body()
+    let start = DispatchTime.now().uptimeNanoseconds
+    var elapsed: UInt64 = 0
+    var runs = 0
+    repeat {
+        body()
+        runs += 1
+        elapsed = DispatchTime.now().uptimeNanoseconds - start
+    } while Double(elapsed) < seconds * 1e9
+    return Double(elapsed) / 1e9 / Double(runs)
+}
+
+// MARK: - Decoder
+
+/// A minute of 30 fps MTC, as it might arrive from a busy show network: every quarter frame
+/// shares its packet with MIDI clock, a note on and off (the off in running status), and now
+/// and then a controller.
+func mixedTraffic() -> (bytes: [UInt8], packets: [Range<Int>], messages: Int) {
+    var bytes: [UInt8] = []
+    var packets: [Range<Int>] = []
+    var messages = 0
+    for frame in stride(from: 0, to: 30 * 60, by: 2) {
+        let timecode = F53Timecode(framerate: ._2997nd, hh: 1, mm: 0, ss: UInt(frame / 30), ff: UInt(frame % 30))
+        for (index, quarterFrame) in quarterFrames(timecode).enumerated() {
+            let start = bytes.count
+            let note = UInt8(36 + index * 3)
+            bytes += quarterFrame
+            bytes += [0xf8]
+            bytes += [0x90, note, 100, note, 0]
+            messages += 4
+            if index == 0 {
+                bytes += [0xb0, 7, UInt8(timecode.ss * 2)]
+                messages += 1
+            }
+            packets.append(start..<bytes.count)
+        }
+    }
+    return (bytes, packets, messages)
+}
+
+func benchmarkDecoder() {
+    let traffic = mixedTraffic()
+    let seconds = traffic.bytes.withUnsafeBufferPointer { bytes in
+        measure {
+            var decoder = MTCDecoder()
+            var frames = 0
+            for packet in traffic.packets {
+                decoder.decode(UnsafeBufferPointer(rebasing: bytes[packet])) { _, _ in
+                    frames += 1
+                }
+            }
+            consume(frames)
+        }
+    }
+    print(String(format: "decoder: %.1f M messages/s, %.1f MB/s (%ld messages in %ld packets, %.1f us)",
+                 Double(traffic.messages) / seconds / 1e6, Double(traffic.bytes.count) / seconds / 1e6,
+                 traffic.messages, traffic.packets.count, seconds * 1e6))
+    #if canImport(SnoizeMIDI)
+    benchmarkMessageParser(traffic, decoderSeconds: seconds)
+    #endif
+}
+
+#if canImport(SnoizeMIDI)
+/// What the app did before MTCDecoder, for comparison: SnoizeMIDI parses each packet list into
+/// `Message` objects, and the receiver picks the quarter frames out with `as? SystemCommonMessage`.
+final class QuarterFrameCollector: NSObject, MessageDestination {
+    var messages = 0
+    var frames = 0
+    var nibbles = [UInt8](repeating: 0, count: 8)
+
+    func takeMIDIMessages(_ messages: [Message]) {
+        self.messages += messages.count
+        for message in messages {
+            if let message = message as? SystemCommonMessage, message.statusByte == 0xf1, let d1 = message.dataByte1 {
+                nibbles[Int(d1 >> 4 & 0x07)] = d1 & 0x0f
+                if d1 >> 4 == 7 {
+                    frames += 1
+                }
+            }
+        }
+    }
+}
+
+/// The traffic as CoreMIDI would hand it over, in packet lists of up to 64 packets.
+func packetLists(_ traffic: (bytes: [UInt8], packets: [Range<Int>], messages: Int)) -> [UnsafeMutableRawPointer] {
+    stride(from: 0, to: traffic.packets.count, by: 64).map { first -> UnsafeMutableRawPointer in
+        let packets = traffic.packets[first..<min(first + 64, traffic.packets.count)]
+        let size = MemoryLayout<MIDIPacketList>.size + packets.reduce(0) { $0 + $1.count + 16 }
+        let storage = UnsafeMutableRawPointer.allocate(byteCount: size, alignment: 8)
+        let list = storage.bindMemory(to: MIDIPacketList.self, capacity: 1)
+        var packet = MIDIPacketListInit(list)
+        for range in packets {
+            packet = traffic.bytes[range].withUnsafeBufferPointer { data in
+                MIDIPacketListAdd(list, size, packet, 0, data.count, data.baseAddress!)
+            }
+        }
+        return storage
+    }
+}
+
+func benchmarkMessageParser(_ traffic: (bytes: [UInt8], packets: [Range<Int>], messages: Int), decoderSeconds: Double) {
+    let context = MIDIContext()
+    let stream = PortInputStream(midiContext: context)
+    let collector = QuarterFrameCollector()
+    stream.messageDestination = collector
+    let parser = stream.createParser(originatingEndpoint: nil)
+    let lists = packetLists(traffic)
+    defer {
+        lists.forEach { $0.deallocate() }
+    }
+    let seconds = measure {
+        for list in lists {
+            parser.takePacketList(list.assumingMemoryBound(to: MIDIPacketList.self))
+        }
+        consume(collector.frames)
+    }
+    print(String(format: "decoder (SnoizeMIDI messages): %.1f M messages/s, %.1f MB/s (%.1f us, %.1fx MTCDecoder's time)",
+                 Double(traffic.messages) / seconds / 1e6, Double(traffic.bytes.count) / seconds / 1e6,
+                 seconds * 1e6, seconds / decoderSeconds))
+}
+#endif
+
+// MARK: - Timecode
+
+func benchmarkTimecode() {
+    // Frame counts spread over the whole day, at a drop-frame rate, which takes the most arithmetic
+    let framerate = F53Timecode.Framerate._2997df
+    let count = 1 << 16
+    let framesPerDay = framerate.table.framesPerDay
+    let frames = (0..<UInt(count)).map { $0 &* 2_654_435_761 % framesPerDay }
+    let timecodes = F53Timecode.timecodes(framerate: framerate, framesFromZero: frames)
+
+    let toTimecode = measure {
+        var total: UInt = 0
+        for frame in frames {
+            total &+= F53Timecode(framerate: framerate, framesFromZero: frame).ff
+        }
+        consume(Int(truncatingIfNeeded: total))
+    }
+    let toFrames = measure {
+        var total: UInt = 0
+        for timecode in timecodes {
+            total &+= timecode.framesFromZero
+        }
+        consume(Int(truncatingIfNeeded: total))
+    }
+    var text = [UInt8](repeating: 0, count: F53Timecode.formattedLength)
+    let write = text.withUnsafeMutableBufferPointer { buffer in
+        measure {
+            var total = 0
+            for timecode in timecodes {
+                total &+= timecode.write(into: buffer) + Int(buffer[10])
+            }
+            consume(total)
+        }
+    }
+    print(String(format: "timecode: %.2f ns per frames-to-timecode, %.2f ns per timecode-to-frames, %.2f ns per write(into:)",
+                 toTimecode * 1e9 / Double(count), toFrames * 1e9 / Double(count), write * 1e9 / Double(count)))
+}
+
+// MARK: - Raster
+
+func benchmarkRaster() {
+    // About the size of a full-screen display on a 5K screen
+    let atlas = GlyphAtlas(digitWidth: 300, separatorWidth: 120, height: 640) { character, cell, _, _ in
+        cell.initialize(repeating: character)
+    }
+    let raster = TimecodeRaster(atlas: atlas)
+    let count = 30 * 60
+    let timecodes = (0..<count).map { F53Timecode(framerate: ._2997nd, framesFromZero: 108_000 + UInt($0)) }
+
+    // What TimecodeView does with each frame: update the cells, then, as it draws, find the
+    // cells that fall in the dirty columns. The drawing itself needs AppKit, so isn't timed.
+    var columns = 0
+    var cells = 0
+    let seconds = measure {
+        columns = 0
+        cells = 0
+        for timecode in timecodes {
+            guard let dirty = raster.update(timecode) else {
+                continue
+            }
+            columns += dirty.count
+            for index in 0..<TimecodeRaster.cellCount {
+                let cell = raster.cell(index)
+                if cell.x < dirty.upperBound && cell.x + atlas.width(of: cell.character) > dirty.lowerBound {
+                    cells += 1
+                }
+            }
+        }
+        consume(cells)
+    }
+    print(String(format: "raster: %.0f ns per update (%ld x %ld pixels, %.0f columns and %.1f cells redrawn per update)",
+                 seconds * 1e9 / Double(count), raster.width, raster.height, Double(columns) / Double(count), Double(cells) / Double(count)))
+}
+
+// MARK: - Event log
+
+/// Peak resident memory of this process so far, in bytes.
+func peakResidentBytes() -> Int {
+    var usage = rusage()
+    getrusage(RUSAGE_SELF, &usage)
+    #if os(Linux)
+    return usage.ru_maxrss * 1024
+    #else
+    return usage.ru_maxrss
+    #endif
+}
+
+func benchmarkEventLog() {
+    let directory = FileManager.default.temporaryDirectory.appendingPathComponent("tcdbench-\(ProcessInfo.processInfo.processIdentifier)")
+    defer {
+        try? FileManager.default.removeItem(at: directory)
+    }
+    let log = EventLog(capacity: 5000, journalDirectory: directory) // As in the app
+    let timecode = F53Timecode(framerate: ._25, hh: 1, mm: 0, ss: 0, ff: 0)
+    var statistics = TimecodeClock.Statistics()
+    statistics.rmsJitter = 0.0002
+    func append(_ count: Int) {
+        for index in 0..<count {
+            let time = Double(index)
+            switch index % 3 {
+            case 0:
+                log.append(.start(timecode, time: time))
+            case 1:
+                log.append(.discontinuity(from: timecode, to: timecode.adding(frames: index), time: time))
+            default:
+                log.append(.stop(timecode.adding(frames: index), statistics: statistics, time: time))
+            }
+        }
+    }
+
+    // Fill the ring and go through every journal file once, so everything that's ever allocated has been.
+    append(EventJournal.capacity * (EventJournal.keptFiles + 1))
+    let before = peakResidentBytes()
+    let count = 1_000_000
+    let start = DispatchTime.now().uptimeNanoseconds
+    append(count)
+    let seconds = Double(DispatchTime.now().uptimeNanoseconds - start) / 1e9
+    let after = peakResidentBytes()
+    consume(log.totalCount)
+    print(String(format: "eventlog: %.0f ns per event over %ld events; peak memory %.1f MB before, %.1f MB after",
+                 seconds * 1e9 / Double(count), count, Double(before) / 1e6, Double(after) / 1e6))
+}
+
+// MARK: - Replay
+
+func benchmarkReplay() {
+    // Three hours of 29.97 fps MTC, each quarter frame sharing its packet with MIDI clock, stopping
+    // for ten seconds and relocating on the hour, as a long show with a couple of holds might
+    let framerate = F53Timecode.Framerate._2997nd
+    let hours = 3
+    let quarterFrameNanos = 1e9 / (4 * framerate.nominalFPS)
+    let piecesPerHour = Int(3600 / quarterFrameNanos * 1e9) / 8 * 8
+    let recordSize = CaptureFormat.recordSize(byteCount: 3)
+    var record = [UInt8](repeating: 0, count: recordSize)
+    var capture = CaptureFormat.fileHeader(startTime: 0)
+    capture.reserveCapacity(capture.count + hours * piecesPerHour * recordSize)
+    for hour in 0..<hours {
+        let start = F53Timecode(framerate: framerate, hh: UInt(hour + 1), mm: 0, ss: 0, ff: 0)
+        let startNanos = 1e9 + Double(hour) * 3610e9
+        var message: [[UInt8]] = []
+        for piece in 0..<piecesPerHour {
+            if piece % 8 == 0 {
+                message = quarterFrames(start.adding(frames: piece / 4))
+            }
+            record.withUnsafeMutableBytes { bytes in
+                CaptureFormat.storeRecordHeader(nanos: UInt64(startNanos + Double(piece) * quarterFrameNanos), sourceID: 1, byteCount: 3, at: bytes.baseAddress!)
+                bytes[CaptureFormat.recordHeaderSize] = message[piece % 8][0]
+                bytes[CaptureFormat.recordHeaderSize + 1] = message[piece % 8][1]
+                bytes[CaptureFormat.recordHeaderSize + 2] = 0xf8
+            }
+            capture.append(contentsOf: record)
+        }
+    }
+
+    let url = FileManager.default.temporaryDirectory.appendingPathComponent("tcdbench-\(ProcessInfo.processInfo.processIdentifier).\(CaptureFormat.pathExtension)")
+    defer {
+        try? FileManager.default.removeItem(at: url)
+    }
+    let reader: CaptureReader
+    do {
+        try capture.write(to: url)
+        reader = try CaptureReader(url: url)
+    } catch {
+        FileHandle.standardError.write("replay: \(error)\n".data(using: .utf8)!)
+        return
+    }
+
+    var summary = CaptureReplayer.Summary()
+    var events = 0
+    let seconds = measure {
+        events = 0
+        summary = CaptureReplayer().replay(reader) { _ in
+            events += 1
+        }
+        consume(summary.frames)
+    }
+    print(String(format: "replay: %.0fx real time, %.1f M packets/s, %.1f MB/s (%.1f hours, %ld packets, %.1f MB, %ld events)",
+                 summary.captureDuration / seconds, Double(summary.packets) / seconds / 1e6, Double(capture.count) / seconds / 1e6,
+                 summary.captureDuration / 3600, summary.packets, Double(capture.count) / 1e6, events))
+}
+
+// MARK: -
+
+let benchmarks: [(name: String, run: () -> Void)] = [
+    ("decoder", benchmarkDecoder),
+    ("timecode", benchmarkTimecode),
+    ("raster", benchmarkRaster),
+    ("eventlog", benchmarkEventLog),
+    ("replay", benchmarkReplay),
+]
+
+func usage() -> Never {
+    FileHandle.standardError.write("usage: tcdbench [\(benchmarks.map { $0.name }.joined(separator: " | "))]...\n".data(using: .utf8)!)
+    exit(64)
+}
+
+let selected = CommandLine.arguments.dropFirst().map { name -> (name: String, run: () -> Void) in
+    guard let benchmark = benchmarks.first(where: { $0.name == name }) else {
+        usage()
+    }
+    return benchmark
+}
+for benchmark in selected.isEmpty ? benchmarks : selected {
+    benchmark.run()
+}
+FileHandle.standardError.write("checksum \(sink)\n".data(using: .utf8)!)
@@ -0,0 +1,597 @@
+//
+//  main.swift
+//  tcdcheck
+//
+//  Created on 10/17/26.
+//
+//  Checks the app's timecode arithmetic and timing code against cases that can be worked out
+//  exactly, printing one line per check to stdout and exiting non-zero if any of them failed.
+//
+//    tcdcheck [<check>...]
+//
+//  With no arguments it runs them all. `timecode` converts every frame of the day at every rate to
+//  a timecode and back, and expects to get the same frame count, then checks offsets either way and
+//  across midnight, and the text timecodes are written as. `decoder` feeds MTCDecoder full-frame
+//  and MMC Locate messages split across packets, interrupted, padded and cut off, and checks which
+//  frames it reports, and that quarter frames straight after one report from the fourth piece.
+//  `handoff` has several threads push frames into their sources' rings at once while this one
+//  drains them through a SourceArbiter, as the MIDI and main threads do, and checks the followed
+//  source's frames all arrive, in order. `wakeup` checks that the consumer of the rings is woken
+//  exactly once for each time it asks, only by sources it could follow, and never sleeps through a
+//  frame pushed from another thread. `arbiter` steps SourceArbiter through sources starting and
+//  stopping under each selection, and checks which one it follows. `capture` records packets of
+//  every length through CaptureRecorder, wrapping its ring several times, reads them back with
+//  CaptureReader, and checks the file's layout and that truncated and foreign files are handled.
+//  `clock` sends jittered quarter frames, running a known number of ppm fast or slow, through
+//  MTCDecoder into a TimecodeClock at every rate, jumps them partway through, and checks how soon
+//  the clock locks and relocks, how close it predicts where timecode is between frames, and how
+//  close it gets to the true rate.
+//
+//  It doesn't need CoreMIDI or AppKit. To build and run it anywhere Swift runs, from the
+//  repository root:
+//
+//    swift run -c release tcdcheck
+//
+
+import Foundation
+@testable import TimecodeCore
+@testable import TimecodeFixtures
+
+let allFramerates = (0...F53Timecode.Framerate._30df.rawValue).compactMap { F53Timecode.Framerate(rawValue: $0) }
+
+/// Prints how a check went, and returns the number of failures.
+func report(_ name: String, failures: Int, _ details: String) -> Int {
+    print("\(name): \(failures == 0 ? "ok" : "FAILED, \(failures) wrong"); \(details)")
+    return failures
+}
+
+// MARK: - Timecode
+
+func checkTimecode() -> Int {
+    var failures = 0
+    var conversions = 0
+    for framerate in allFramerates {
+        let table = framerate.table
+        for frames in 0..<table.framesPerDay {
+            let timecode = F53Timecode(framerate: framerate, framesFromZero: frames)
+            conversions += 1
+            if timecode.framesFromZero != frames || timecode.hh >= 24 || timecode.ff >= table.fps {
+                if failures < 10 {
+                    FileHandle.standardError.write("timecode: \(frames) frames at \(framerate) became \(timecode.stringRepresentation), \(timecode.framesFromZero) frames\n".data(using: .utf8)!)
+                }
+                failures += 1
+            }
+        }
+    }
+
+    // Offsets either way, across minute boundaries that drop frames and across midnight
+    let offsets: [(from: F53Timecode, frames: Int, expected: String)] = [
+        (F53Timecode(framerate: ._25, hh: 1, mm: 0, ss: 0, ff: 0), 25 * 3600 + 1, "02:00:00:01"),
+        (F53Timecode(framerate: ._25, hh: 1, mm: 0, ss: 0, ff: 0), -1, "00:59:59:24"),
+        (F53Timecode(framerate: ._2997df, hh: 0, mm: 0, ss: 59, ff: 29), 1, "00:01:00;02"),
+        (F53Timecode(framerate: ._2997df, hh: 0, mm: 1, ss: 0, ff: 2), -1, "00:00:59;29"),
+        (F53Timecode(framerate: ._2997df, hh: 0, mm: 9, ss: 59, ff: 29), 1, "00:10:00;00"),
+        (F53Timecode(framerate: ._24, hh: 23, mm: 59, ss: 59, ff: 23), 1, "00:00:00:00"),
+        (F53Timecode(framerate: ._24, hh: 0, mm: 0, ss: 0, ff: 0), -1, "23:59:59:23"),
+        (F53Timecode(framerate: ._30nd, hh: 0, mm: 0, ss: 0, ff: 5), -30 * 86_400 * 2 - 10, "23:59:59:25"),
+    ]
+    for offset in offsets {
+        let added = offset.from.adding(frames: offset.frames).stringRepresentation
+        let subtracted = offset.from.subtracting(frames: -offset.frames).stringRepresentation
+        if added != offset.expected || subtracted != offset.expected {
+            FileHandle.standardError.write("timecode: \(offset.from.stringRepresentation) + \(offset.frames) frames became \(added) adding, \(subtracted) subtracting, expected \(offset.expected)\n".data(using: .utf8)!)
+            failures += 1
+        }
+    }
+
+    // Text, including the drop-frame separator, and a batch that only partly fits
+    let frames: [UInt] = [0, 1799, 1800, 17_982]
+    let expectedLines = ["00:00:00;00", "00:00:59;29", "00:01:00;02", "00:10:00;00"]
+    var text = [UInt8](repeating: UInt8(ascii: "#"), count: 3 * (F53Timecode.formattedLength + 1) - 1)
+    let written = frames.withUnsafeBufferPointer { frames in
+        text.withUnsafeMutableBufferPointer { buffer in
+            F53Timecode.writeLines(framerate: ._2997df, framesFromZero: frames, into: buffer)
+        }
+    }
+    let lines = String(decoding: text[..<written], as: UTF8.self)
+    if written != 2 * (F53Timecode.formattedLength + 1) || lines != expectedLines[0..<2].map({ $0 + "\n" }).joined() || text[written] != UInt8(ascii: "#") {
+        FileHandle.standardError.write("timecode: writeLines wrote \(written) bytes, \(lines.debugDescription), into room for two and a half lines\n".data(using: .utf8)!)
+        failures += 1
+    }
+    let strings = zip(frames, expectedLines).filter { F53Timecode(framerate: ._2997df, framesFromZero: $0.0).stringRepresentation != $0.1 }
+    if !strings.isEmpty || F53Timecode(framerate: ._25, hh: 12, mm: 34, ss: 56, ff: 7).stringRepresentation != "12:34:56:07" {
+        FileHandle.standardError.write("timecode: stringRepresentation got \(strings.map { $0.1 }) wrong\n".data(using: .utf8)!)
+        failures += 1
+    }
+    return report("timecode", failures: failures, "\(conversions) round trips at \(allFramerates.count) rates, \(offsets.count) offsets, text")
+}
+
+// MARK: - Decoder
+
+/// Runs `packets` through `decoder` in order, and describes each frame it reports.
+func decodedFrames(_ packets: [[UInt8]], decoder: inout MTCDecoder) -> [String] {
+    var frames: [String] = []
+    for packet in packets {
+        packet.withUnsafeBufferPointer { bytes in
+            decoder.decode(bytes) { timecode, isSysEx in
+                frames.append(timecode.stringRepresentation + (isSysEx ? " sysex" : ""))
+            }
+        }
+    }
+    return frames
+}
+
+func checkDecoder() -> Int {
+    let fullFrame: [UInt8] = [0xf0, 0x7f, 0x7f, 0x01, 0x01, 0x61, 0x02, 0x03, 0x04, 0xf7] // 01:02:03:04 at 30 fps
+    let locate: [UInt8] = [0xf0, 0x7f, 0x7f, 0x06, 0x44, 0x06, 0x01, 0x41, 0x02, 0x03, 0x04, 0x00, 0xf7] // 01:02:03;04 drop frame
+    let pieces = quarterFrames(F53Timecode(framerate: ._2997nd, hh: 1, mm: 2, ss: 3, ff: 6)).flatMap { $0 }
+    let cases: [(name: String, packets: [[UInt8]], expected: [String])] = [
+        ("full frame", [fullFrame], ["01:02:03:04 sysex"]),
+        ("full frame split across packets", [Array(fullFrame[0..<3]), Array(fullFrame[3..<7]), Array(fullFrame[7...])], ["01:02:03:04 sysex"]),
+        ("MMC Locate", [locate], ["01:02:03;04 sysex"]),
+        // Some senders leave the subframe byte off, even though the byte count says it's there
+        ("MMC Locate without subframes", [Array(locate[0..<11]) + [0xf7]], ["01:02:03;04 sysex"]),
+        ("realtime bytes inside SysEx", [[0xf0, 0xf8, 0x7f, 0x7f, 0xfe, 0x01, 0x01, 0x61, 0xf8, 0x02, 0x03, 0x04, 0xfa, 0xf7]], ["01:02:03:04 sysex"]),
+        // The cut-off message's 0xF7 belongs to nothing, and mustn't complete it
+        ("SysEx cut off by a note", [Array(fullFrame[0..<8]), [0x90, 0x40, 0x7f], [0x04, 0xf7], fullFrame], ["01:02:03:04 sysex"]),
+        ("full frame with extra bytes", [Array(fullFrame[0..<9]) + [0x05, 0xf7]], []),
+        ("long dump", [[0xf0, 0x00, 0x20, 0x29] + (0..<1000).map { UInt8($0 & 0x7f) } + [0xf7], fullFrame], ["01:02:03:04 sysex"]),
+        ("long dump that starts like full frame", [Array(fullFrame[0..<9]) + (0..<600).map { UInt8($0 & 0x7f) } + [0xf7]], []),
+        // On their own, quarter frames take all eight pieces to report a frame...
+        ("quarter frames", [Array(pieces[0..<8]), Array(pieces[8...])], ["01:02:03:07"]),
+        // ...but after a full frame, the first four are enough.
+        ("quarter frames after full frame", [fullFrame, Array(pieces[0..<8]), Array(pieces[8...])],
+         ["01:02:03:04 sysex", "01:02:03:06", "01:02:03:07"]),
+    ]
+
+    var failures = 0
+    for test in cases {
+        var decoder = MTCDecoder()
+        let frames = decodedFrames(test.packets, decoder: &decoder)
+        if frames != test.expected {
+            FileHandle.standardError.write("decoder: \(test.name) reported \(frames), expected \(test.expected)\n".data(using: .utf8)!)
+            failures += 1
+        }
+    }
+    return report("decoder", failures: failures, "\(cases.count) cases")
+}
+
+// MARK: - Frame handoff
+
+func checkHandoff() -> Int {
+    let producerCount = min(max(ProcessInfo.processInfo.activeProcessorCount - 1, 2), 8)
+    let framesPerProducer = 200_000
+    let framerate = F53Timecode.Framerate._25
+    let framesPerDay = Int(framerate.table.framesPerDay)
+    let fullCounts = UnsafeMutablePointer<Int>.allocate(capacity: producerCount) // One per producer, read after it finishes
+    defer {
+        fullCounts.deallocate()
+    }
+    var failures = 0
+    var delivered = 0
+    var waits = 0
+
+    // Follow each producer in turn, while the others keep the arbiter busy draining their rings too.
+    for followed in 0..<producerCount {
+        let sources = (0..<producerCount).map { MTCSource(uniqueID: Int32($0 + 1), name: "Producer \($0 + 1)") }
+        var arbiter = SourceArbiter()
+        arbiter.selection = .only(sources[followed].uniqueID)
+
+        let group = DispatchGroup()
+        for (index, source) in sources.enumerated() {
+            fullCounts[index] = 0
+            group.enter()
+            Thread.detachNewThread {
+                var frame = 0
+                while frame < framesPerProducer {
+                    if source.frames.push(F53Timecode(framerate: framerate, framesFromZero: UInt(frame % framesPerDay)), atNanos: UInt64(frame)) {
+                        frame += 1
+                    } else {
+                        fullCounts[index] += 1 // The ring's full; wait for the consumer rather than drop it
+                        sched_yield()
+                    }
+                }
+                group.leave()
+            }
+        }
+
+        var expected = 0
+        var finished = false
+        while !finished {
+            // Checked before draining, so the last drain sees everything the producers pushed.
+            finished = group.wait(timeout: .now()) == .success
+            arbiter.drain(sources, atNanos: 0) { entry, _ in
+                if entry.nanos != UInt64(expected) || entry.timecode.framesFromZero != UInt(expected % framesPerDay) {
+                    if failures < 10 {
+                        FileHandle.standardError.write("handoff: producer \(followed + 1) expected frame \(expected), got \(entry.nanos) (\(entry.timecode.stringRepresentation))\n".data(using: .utf8)!)
+                    }
+                    failures += 1
+                    expected = Int(entry.nanos)
+                }
+                expected += 1
+            }
+        }
+        if expected != framesPerProducer {
+            FileHandle.standardError.write("handoff: producer \(followed + 1) delivered \(expected) of \(framesPerProducer) frames\n".data(using: .utf8)!)
+            failures += 1
+        }
+        if let backedUp = sources.first(where: { !$0.frames.isEmpty }) {
+            FileHandle.standardError.write("handoff: \(backedUp.name) still has frames queued\n".data(using: .utf8)!)
+            failures += 1
+        }
+        if arbiter.currentSourceID != sources[followed].uniqueID {
+            failures += 1
+        }
+        delivered += expected
+        waits += (0..<producerCount).reduce(0) { $0 + fullCounts[$1] }
+    }
+    return report("handoff", failures: failures, "\(delivered) frames followed from \(producerCount) producers at a time, \(waits) waits on a full ring")
+}
+
+// MARK: - Wakeups
+
+func checkWakeup() -> Int {
+    var failures = 0
+    func expect(_ condition: Bool, _ description: String) {
+        if !condition {
+            FileHandle.standardError.write("wakeup: \(description)\n".data(using: .utf8)!)
+            failures += 1
+        }
+    }
+    let framerate = F53Timecode.Framerate._25
+
+    // One thread: exactly one call claims each request, and filtered sources never do.
+    let sources = [MTCSource(uniqueID: 1, name: "One"), MTCSource(uniqueID: 2, name: "Two")]
+    let wakeup = FrameWakeup()
+    expect(wakeup.framesQueued(from: sources[0]), "the first frame didn't wake the consumer")
+    expect(!wakeup.framesQueued(from: sources[0]), "a second frame woke the consumer before it asked again")
+    expect(!wakeup.wakeOnNextFrame(sources), "asking with nothing queued claimed the wakeup")
+    expect(wakeup.framesQueued(from: sources[1]), "a frame after asking didn't wake the consumer")
+    sources[0].frames.push(F53Timecode(framerate: framerate, framesFromZero: 0), atNanos: 0)
+    expect(wakeup.wakeOnNextFrame(sources), "asking with a frame already queued didn't claim the wakeup")
+    expect(!wakeup.framesQueued(from: sources[0]), "a producer claimed a wakeup the consumer already had")
+    sources[0].frames.drain { _ in }
+    wakeup.follow(.only(2))
+    expect(!wakeup.wakeOnNextFrame(sources), "asking with nothing queued claimed the wakeup")
+    expect(!wakeup.framesQueued(from: sources[0]), "a source that isn't followed woke the consumer")
+    sources[0].frames.push(F53Timecode(framerate: framerate, framesFromZero: 0), atNanos: 0)
+    expect(!wakeup.wakeOnNextFrame(sources), "a queued frame from a source that isn't followed claimed the wakeup")
+    expect(wakeup.framesQueued(from: sources[1]), "the followed source didn't wake the consumer")
+    wakeup.follow(.priority)
+    expect(wakeup.wakeOnNextFrame(sources), "following every source again didn't see the queued frame")
+
+    // Two threads: the consumer sleeps until woken, and never misses a frame a producer pushed.
+    let frameCount = 200_000
+    let source = MTCSource(uniqueID: 1, name: "Producer")
+    let threaded = FrameWakeup()
+    let woken = DispatchSemaphore(value: 0)
+    _ = threaded.framesQueued(from: source) // Claim the request it starts with, so every wakeup below answers one
+    Thread.detachNewThread {
+        var frame = 0
+        while frame < frameCount {
+            guard source.frames.push(F53Timecode(framerate: framerate, framesFromZero: UInt(frame % 100)), atNanos: UInt64(frame)) else {
+                sched_yield()
+                continue
+            }
+            frame += 1
+            if threaded.framesQueued(from: source) {
+                woken.signal()
+            }
+        }
+    }
+    var received = 0
+    var sleeps = 0
+    while received < frameCount {
+        if !threaded.wakeOnNextFrame([source]) {
+            sleeps += 1
+            if woken.wait(timeout: .now() + 1) == .timedOut {
+                expect(false, "the consumer wasn't woken with \(received) of \(frameCount) frames received")
+                break
+            }
+        }
+        source.frames.drain { entry in
+            if entry.nanos != UInt64(received) {
+                expect(false, "expected frame \(received), got \(entry.nanos)")
+                received = Int(entry.nanos)
+            }
+            received += 1
+        }
+    }
+    return report("wakeup", failures: failures, "\(received) frames from another thread, \(sleeps) sleeps")
+}
+
+// MARK: - Arbiter
+
+func checkArbiter() -> Int {
+    // Each step pushes a frame into some of the sources, given by index in priority order, then
+    // drains them all at a time in ms, and says which source should be followed, by unique ID,
+    // and whose frames should come out. Sources stay active for 200 ms after their last frame.
+    // Times start a second in, so no source counts as active just for never having sent anything.
+    typealias Step = (pushes: [Int], ms: UInt64, followed: Int32?, from: [Int])
+    let cases: [(selection: SourceSelection, steps: [Step])] = [
+        (.firstActive, [
+            ([1], 1000, 2, [1]),
+            ([0, 1], 1010, 2, [1]), // Stays with the source that started first
+            ([0], 1300, 1, [0]), // Until it stops
+            ([], 1600, nil, []),
+        ]),
+        (.priority, [
+            ([1], 1000, 2, [1]),
+            ([0, 1], 1010, 1, [0]), // Moves to the first source in the list as soon as it starts
+            ([1], 1300, 2, [1]),
+        ]),
+        (.only(3), [
+            ([0, 1], 1000, 3, []), // Even while it's silent
+            ([2], 1010, 3, [2]),
+        ]),
+        (.only(9), [
+            ([0], 1000, nil, []), // There isn't one
+        ]),
+    ]
+
+    var failures = 0
+    var stepCount = 0
+    for test in cases {
+        let sources = (1...3).map { MTCSource(uniqueID: Int32($0), name: "Source \($0)") }
+        var arbiter = SourceArbiter()
+        arbiter.selection = test.selection
+        for step in test.steps {
+            for index in step.pushes {
+                sources[index].frames.push(F53Timecode(framerate: ._25, hh: UInt(index), mm: 0, ss: 0, ff: 0), atNanos: step.ms * 1_000_000)
+            }
+            var from: [Int] = []
+            arbiter.drain(sources, atNanos: step.ms * 1_000_000) { entry, _ in
+                from.append(Int(entry.timecode.hh))
+            }
+            stepCount += 1
+            if arbiter.currentSourceID != step.followed || from != step.from || sources.contains(where: { !$0.frames.isEmpty }) {
+                FileHandle.standardError.write("arbiter: \(test.selection) at \(step.ms) ms followed \(arbiter.currentSourceID.map { "\($0)" } ?? "none") with frames from \(from), expected \(step.followed.map { "\($0)" } ?? "none") with \(step.from)\n".data(using: .utf8)!)
+                failures += 1
+            }
+        }
+    }
+    return report("arbiter", failures: failures, "\(stepCount) steps in \(cases.count) selections")
+}
+
+// MARK: - Capture
+
+func checkCapture() -> Int {
+    var failures = 0
+    func fail(_ description: String) {
+        if failures < 10 {
+            FileHandle.standardError.write("capture: \(description)\n".data(using: .utf8)!)
+        }
+        failures += 1
+    }
+    let directory = FileManager.default.temporaryDirectory.appendingPathComponent("tcdcheck-\(ProcessInfo.processInfo.processIdentifier)")
+    defer {
+        try? FileManager.default.removeItem(at: directory)
+    }
+    guard (try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)) != nil else {
+        return report("capture", failures: 1, "couldn't create \(directory.path)")
+    }
+    let url = directory.appendingPathComponent("check.\(CaptureFormat.pathExtension)")
+
+    // Packets of every length from 0 to 13 bytes, so most need padding, from sources whose IDs
+    // have the top bit set and clear, and several times the ring's size in all, so it wraps.
+    var random = SplitMix64(state: 1)
+    let sourceIDs: [Int32] = [1, -2, 0x1234_5678, Int32.min]
+    var packets: [(bytes: [UInt8], sourceID: Int32, nanos: UInt64)] = []
+    var size = 0
+    while size < 4 * CaptureRecorder.ringSize {
+        let bytes = (0..<packets.count % 14).map { _ in UInt8.random(in: 0...0xff, using: &random) }
+        packets.append((bytes, sourceIDs[packets.count % sourceIDs.count], 1_000_000_000 + UInt64(packets.count) * 1_041_667))
+        size += CaptureFormat.recordSize(byteCount: bytes.count)
+    }
+
+    let recorder: CaptureRecorder
+    do {
+        recorder = try CaptureRecorder(url: url)
+    } catch {
+        return report("capture", failures: 1, "couldn't create \(url.path): \(error)")
+    }
+    // Whenever the ring's full, the packet's dropped; wait for the writer to catch up and send it again.
+    var waits = 0
+    for packet in packets {
+        while true {
+            let dropped = recorder.droppedPackets
+            packet.bytes.withUnsafeBufferPointer { bytes in
+                recorder.record(bytes, sourceID: packet.sourceID, atNanos: packet.nanos)
+            }
+            if recorder.droppedPackets == dropped {
+                break
+            }
+            waits += 1
+            Thread.sleep(forTimeInterval: 0.01)
+        }
+    }
+    recorder.close()
+
+    do {
+        let reader = try CaptureReader(url: url)
+        var index = 0
+        reader.forEachPacket { bytes, sourceID, nanos in
+            if index >= packets.count {
+                fail("read back more packets than were recorded")
+            } else if Array(bytes) != packets[index].bytes || sourceID != packets[index].sourceID || nanos != packets[index].nanos {
+                fail("packet \(index) read back as \(bytes.count) bytes from \(sourceID) at \(nanos), recorded as \(packets[index].bytes.count) from \(packets[index].sourceID) at \(packets[index].nanos)")
+            }
+            index += 1
+        }
+        if index != packets.count {
+            fail("read back \(index) of \(packets.count) packets")
+        }
+
+        // The layout's fixed, whatever the byte order of the machine that recorded it.
+        let data = reader.data
+        let firstRecord = CaptureFormat.fileHeaderSize
+        if Array(data[0..<8]) != [0x54, 0x43, 0x44, 0x43, 0x01, 0x00, 0x00, 0x00]
+            || Array(data[firstRecord..<firstRecord + 16]) != [0x00, 0xca, 0x9a, 0x3b, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00] {
+            fail("the file header or first record isn't laid out little-endian")
+        }
+
+        // A capture cut off partway through a record reads up to the record before.
+        let truncated = directory.appendingPathComponent("truncated.\(CaptureFormat.pathExtension)")
+        try data[0..<data.count - 3].write(to: truncated)
+        var truncatedCount = 0
+        try CaptureReader(url: truncated).forEachPacket { _, _, _ in
+            truncatedCount += 1
+        }
+        if truncatedCount != packets.count - 1 {
+            fail("a truncated capture read back \(truncatedCount) packets, not \(packets.count - 1)")
+        }
+
+        var newer = data
+        newer[4] = 2
+        try newer.write(to: truncated)
+        do {
+            _ = try CaptureReader(url: truncated)
+            fail("read a capture with a newer version")
+        } catch CaptureError.unsupportedVersion {
+        }
+        try Data(count: 8).write(to: truncated)
+        do {
+            _ = try CaptureReader(url: truncated)
+            fail("read a file that isn't a capture")
+        } catch CaptureError.notACapture {
+        }
+    } catch {
+        fail("\(error)")
+    }
+    return report("capture", failures: failures, "\(packets.count) packets, \(size / 1024) KB through a \(CaptureRecorder.ringSize / 1024) KB ring, \(waits) waits on a full ring")
+}
+
+// MARK: - Clock
+
+/// How the clock followed one stretch of unbroken timecode.
+struct ClockSegment {
+    var start: Double // Seconds
+    var lockTime = 0.0 // Seconds from `start` until the position error stayed under `lockedError`
+    var maxError = 0.0 // Frames, once it's had time to settle
+    private var rateErrors: [(Double, Double)] = [] // Seconds, and fraction off the true rate
+
+    static let lockedError = 0.1
+
+    init(start: Double) {
+        self.start = start
+    }
+
+    mutating func take(atSeconds seconds: Double, positionError error: Double, rateError: Double, settleTime: Double) {
+        if abs(error) >= ClockSegment.lockedError {
+            lockTime = seconds - start
+        }
+        if seconds - start >= settleTime {
+            maxError = max(maxError, abs(error))
+        }
+        rateErrors.append((seconds, rateError))
+    }
+
+    /// Average rate error over the last `seconds` before `end`, in ppm
+    func rateErrorPPM(lastSeconds seconds: Double, before end: Double) -> Double {
+        let recent = rateErrors.filter { $0.0 >= end - seconds }
+        return recent.isEmpty ? .infinity : recent.reduce(0) { $0 + $1.1 } / Double(recent.count) * 1e6
+    }
+}
+
+func checkClock() -> Int {
+    let seconds = 20.0
+    let jumpSeconds = 10.0
+    let jumpFrames: UInt = 100
+    let jitter = 500_000.0 // ns either way
+    let offsetPPM = 300.0 // Fast at even rates, slow at odd
+    let lockLimit = 0.25 // Seconds
+    let settleTime = 2.0 // Seconds after locking or relocking before the position error is held to...
+    let errorLimit = 0.025 // ...this many frames
+    let rateLimit = 100.0 // ppm, averaged over the last 5 s before the jump and the end
+    let startNanos = 1_000_000_000.0
+    var failures = 0
+
+    for framerate in allFramerates {
+        // MTC can't tell the pulldown rates from the integer ones, so the clock is told 24 when
+        // timecode is really going at 23.976, and has to find that out for itself.
+        let label = MTCMode(framerate).asFramerate()
+        let ppm = framerate.rawValue % 2 == 0 ? offsetPPM : -offsetPPM
+        let trueFPS = framerate.nominalFPS * (1 + ppm * 1e-6)
+        let quarterFrameNanos = 1e9 / (4 * trueFPS)
+        let start = F53Timecode(framerate: label, hh: 1, mm: 0, ss: 0, ff: 0).framesFromZero
+
+        var random = SplitMix64(state: UInt64(framerate.rawValue) + 1)
+        var decoder = MTCDecoder()
+        var clock = TimecodeClock()
+        var segments = [ClockSegment(start: 0)]
+        var relocks: [Double] = []
+        var jump: UInt = 0
+        var message: [[UInt8]] = []
+
+        for index in 0..<Int(seconds * 4 * trueFPS) {
+            let ideal = Double(index) * quarterFrameNanos
+            let piece = index % 8
+            if piece == 0 {
+                if jump == 0 && ideal >= jumpSeconds * 1e9 {
+                    jump = jumpFrames
+                    segments.append(ClockSegment(start: ideal / 1e9))
+                }
+                message = quarterFrames(F53Timecode(framerate: label, framesFromZero: start + jump + UInt(index / 4)))
+            }
+
+            let nanos = UInt64(startNanos + ideal + Double.random(in: -jitter...jitter, using: &random))
+            message[piece].withUnsafeBufferPointer { bytes in
+                decoder.decode(bytes) { timecode, isSysEx in
+                    if !clock.takeFrame(timecode, atNanos: nanos, isSysEx: isSysEx) {
+                        relocks.append(ideal / 1e9)
+                    }
+                }
+            }
+
+            // Between reports, compare where the clock thinks timecode is with where it really is.
+            if piece % 4 == 1, let position = clock.position(atNanos: UInt64(startNanos + ideal)) {
+                let truth = Double(start + jump) + ideal / 1e9 * trueFPS
+                segments[segments.count - 1].take(atSeconds: ideal / 1e9, positionError: position - truth, rateError: clock.estimatedFPS / trueFPS - 1, settleTime: settleTime)
+            }
+        }
+
+        let ends = [jumpSeconds, seconds]
+        let rateErrors = zip(segments, ends).map { $0.rateErrorPPM(lastSeconds: 5, before: $1) }
+        // Once at the start, once on the first frame after the jump, and never otherwise
+        let relockedOnJump = segments.count == 2 && relocks.count == 2 && relocks[0] < 0.1 && relocks[1] >= segments[1].start && relocks[1] < segments[1].start + 0.1
+        let passed = relockedOnJump
+            && segments.allSatisfy { $0.lockTime <= lockLimit && $0.maxError < errorLimit }
+            && rateErrors.allSatisfy { abs($0) < rateLimit }
+        if !passed {
+            failures += 1
+        }
+        print((passed ? "" : "FAILED: ") + "clock at \(framerate) " + String(format: "%+.0f ppm: locked in %.3f s, relocked in %.3f s (%ld relocks); position error %.4f, %.4f frames max; rate error %+.1f, %+.1f ppm",
+                                                                      ppm, segments[0].lockTime, segments.last!.lockTime, relocks.count,
+                                                                      segments[0].maxError, segments.last!.maxError, rateErrors[0], rateErrors.last!))
+    }
+    return report("clock", failures: failures, "\(allFramerates.count) rates, \(Int(jitter / 1000)) us jitter, a \(jumpFrames)-frame jump at \(Int(jumpSeconds)) s")
+}
+
+// MARK: -
+
+let checks: [(name: String, run: () -> Int)] = [
+    ("timecode", checkTimecode),
+    ("decoder", checkDecoder),
+    ("handoff", checkHandoff),
+    ("wakeup", checkWakeup),
+    ("arbiter", checkArbiter),
+    ("capture", checkCapture),
+    ("clock", checkClock),
+]
+
+func usage() -> Never {
+    FileHandle.standardError.write("usage: tcdcheck [\(checks.map { $0.name }.joined(separator: " | "))]...\n".data(using: .utf8)!)
+    exit(64)
+}
+
+let selected = CommandLine.arguments.dropFirst().map { name -> (name: String, run: () -> Int) in
+    guard let check = checks.first(where: { $0.name == name }) else {
+        usage()
+    }
+    return check
+}
+var failures = 0
+for check in selected.isEmpty ? checks : selected {
+    failures += check.run()
+}
+exit(failures == 0 ? 0 : 1)
@@ -0,0 +1,541 @@
+//
+//  main.swift
+//  tcdltc
+//
+//  Created on 10/17/26.
+//
+//  Generates LTC as WAV files, and decodes WAV files with the app's LTC decoder, reporting what
+//  it found on each channel and how many times faster than real time it went.
+//
+//    tcdltc generate [--rate 24|25|29.97|29.97df|30|30df] [--speed <multiple, negative for reverse>]
+//                    [--sample-rate <Hz>] [--channels <n>] [--seconds <s>] [--format float|16|24|32]
+//                    <out.wav>
+//    tcdltc decode <in.wav>
+//    tcdltc check
+//
+//  `check` generates LTC in memory at every rate, at sample rates from 44.1 to 192 kHz, forwards,
+//  backwards, at several steady speeds, ramping up and down, and band-limited with noise added. It
+//  also writes LTC to WAV files in each sample format and reads it back. It decodes it all, and
+//  exits non-zero if any frame was missed or wrong.
+//
+//  It doesn't need CoreAudio or AppKit. To build and run it anywhere Swift runs, from the
+//  repository root:
+//
+//    swift run -c release tcdltc check
+//
+
+import Foundation
+@testable import TimecodeCore
+@testable import TimecodeFixtures
+
+func fail(_ message: String) -> Never {
+    FileHandle.standardError.write("tcdltc: \(message)\n".data(using: .utf8)!)
+    exit(1)
+}
+
+func usage() -> Never {
+    FileHandle.standardError.write("""
+        usage: tcdltc generate [--rate 24|25|29.97|29.97df|30|30df] [--speed <multiple>] [--sample-rate <Hz>] [--channels <n>] [--seconds <s>] [--format float|16|24|32] <out.wav>
+               tcdltc decode <in.wav>
+               tcdltc check
+
+        """.data(using: .utf8)!)
+    exit(64)
+}
+
+// MARK: - Generating
+
+/// The 80 bits of an LTC frame, in the order they're sent.
+func ltcBits(_ timecode: F53Timecode) -> [Bool] {
+    var bits = [Bool](repeating: false, count: 80)
+    func put(_ start: Int, _ width: Int, _ value: UInt) {
+        for offset in 0..<width {
+            bits[start + offset] = value >> UInt(offset) & 1 != 0
+        }
+    }
+    put(0, 4, timecode.ff % 10)
+    put(8, 2, timecode.ff / 10)
+    bits[10] = timecode.framerate.isDropFrame
+    put(16, 4, timecode.ss % 10)
+    put(24, 3, timecode.ss / 10)
+    put(32, 4, timecode.mm % 10)
+    put(40, 3, timecode.mm / 10)
+    put(48, 4, timecode.hh % 10)
+    put(56, 2, timecode.hh / 10)
+    put(64, 16, 0xbffc) // Sync word
+    return bits
+}
+
+/// Biphase-mark audio for `frames`, played at `speed` (negative for backwards).
+func ltcSamples(_ frames: [F53Timecode], speed: Double, sampleRate: Double, amplitude: Float = 0.5) -> [Float] {
+    return ltcSamples(frames, sampleRate: sampleRate, amplitude: amplitude) { _ in speed }
+}
+
+/// Biphase-mark audio for `frames`, with the speed given as a function of how far through them
+/// playback has got, from 0 to 1. It plays backwards if the speed starts out negative; after that
+/// only the size of the speed counts, and it mustn't be zero.
+func ltcSamples(_ frames: [F53Timecode], sampleRate: Double, amplitude: Float = 0.5, speed: (Double) -> Double) -> [Float] {
+    var bits = frames.flatMap(ltcBits)
+    if speed(0) < 0 {
+        bits.reverse()
+    }
+
+    // Every bit starts with a transition, and a one has another in the middle.
+    var halfBits: [Float] = []
+    halfBits.reserveCapacity(bits.count * 2)
+    var level = amplitude
+    for bit in bits {
+        level = -level
+        halfBits.append(level)
+        if bit {
+            level = -level
+        }
+        halfBits.append(level)
+    }
+
+    let fps = frames.first?.framerate.nominalFPS ?? 30
+    let count = Double(halfBits.count)
+    var samples: [Float] = []
+    var position = 0.0
+    while position < count {
+        samples.append(halfBits[Int(position)])
+        position += 160 * fps * abs(speed(position / count)) / sampleRate
+    }
+    return samples
+}
+
+/// `samples` through a one-pole low-pass filter at `cutoff` Hz, with white noise up to `noise`
+/// added, like LTC that's been down a long cable into a cheap input.
+func degraded(_ samples: [Float], sampleRate: Double, cutoff: Double, noise: Float, seed: UInt64) -> [Float] {
+    var random = SplitMix64(state: seed)
+    let coefficient = Float(1 - exp(-2 * Double.pi * cutoff / sampleRate))
+    var filtered: Float = 0
+    return samples.map { sample in
+        filtered += coefficient * (sample - filtered)
+        return filtered + Float.random(in: -noise...noise, using: &random)
+    }
+}
+
+// MARK: - WAV files
+
+struct Wave {
+    var sampleRate: Double
+    var channels: [[Float]]
+}
+
+func readWave(_ url: URL) throws -> Wave {
+    let data = try Data(contentsOf: url, options: .alwaysMapped)
+    return try data.withUnsafeBytes { bytes -> Wave in
+        // Chunks only promise 2-byte alignment, so everything is put together a byte at a time.
+        func u16(_ offset: Int) -> Int { Int(bytes[offset]) | Int(bytes[offset + 1]) << 8 }
+        func u32(_ offset: Int) -> Int { u16(offset) | u16(offset + 2) << 16 }
+        func tag(_ offset: Int) -> String { String(decoding: bytes[offset ..< offset + 4], as: UTF8.self) }
+
+        guard bytes.count >= 12, tag(0) == "RIFF", tag(8) == "WAVE" else {
+            throw CocoaError(.fileReadCorruptFile)
+        }
+        var format = 0, channelCount = 0, sampleRate = 0, bitsPerSample = 0
+        var offset = 12
+        while offset + 8 <= bytes.count {
+            let size = u32(offset + 4)
+            let body = offset + 8
+            if tag(offset) == "fmt " && size >= 16 {
+                format = u16(body)
+                channelCount = u16(body + 2)
+                sampleRate = u32(body + 4)
+                bitsPerSample = u16(body + 14)
+                if format == 0xfffe && size >= 26 {
+                    format = u16(body + 24) // WAVE_FORMAT_EXTENSIBLE: the real format starts the subformat GUID
+                }
+            } else if tag(offset) == "data" && channelCount > 0 {
+                let bytesPerSample = bitsPerSample / 8
+                let frameCount = min(size, bytes.count - body) / (bytesPerSample * channelCount)
+                var channels = [[Float]](repeating: [Float](repeating: 0, count: frameCount), count: channelCount)
+                for frame in 0..<frameCount {
+                    for channel in 0..<channelCount {
+                        let at = body + (frame * channelCount + channel) * bytesPerSample
+                        switch (format, bitsPerSample) {
+                        case (3, 32):
+                            channels[channel][frame] = Float(bitPattern: UInt32(u32(at)))
+                        case (1, 16):
+                            channels[channel][frame] = Float(Int16(truncatingIfNeeded: u16(at))) / 32768
+                        case (1, 24):
+                            let value = Int32(bitPattern: UInt32(bytes[at]) << 8 | UInt32(bytes[at + 1]) << 16 | UInt32(bytes[at + 2]) << 24)
+                            channels[channel][frame] = Float(value) / 2147483648
+                        case (1, 32):
+                            channels[channel][frame] = Float(Int32(truncatingIfNeeded: u32(at))) / 2147483648
+                        default:
+                            throw CocoaError(.fileReadUnsupportedScheme)
+                        }
+                    }
+                }
+                return Wave(sampleRate: Double(sampleRate), channels: channels)
+            }
+            offset = body + size + (size & 1)
+        }
+        throw CocoaError(.fileReadCorruptFile)
+    }
+}
+
+enum SampleFormat: String, CaseIterable {
+    case float32 = "float", int16 = "16", int24 = "24", int32 = "32"
+
+    var bitsPerSample: Int {
+        switch self {
+        case .int16: return 16
+        case .int24: return 24
+        case .float32, .int32: return 32
+        }
+    }
+
+    /// The most a sample in -1...1 can change going through a file and back.
+    var tolerance: Float {
+        switch self {
+        case .float32: return 0
+        case .int16: return 1 / 32768
+        case .int24: return 1 / 8388608
+        case .int32: return .ulpOfOne // Float runs out of precision first
+        }
+    }
+}
+
+/// Writes samples in `format`, little-endian. All channels must be the same length. Over two
+/// channels, the format is WAVE_FORMAT_EXTENSIBLE, with no speaker positions.
+func writeWave(_ wave: Wave, to url: URL, format: SampleFormat = .float32) throws {
+    let channelCount = wave.channels.count
+    let frameCount = wave.channels.first?.count ?? 0
+    let bytesPerSample = format.bitsPerSample / 8
+    let dataSize = frameCount * channelCount * bytesPerSample
+    let extensible = channelCount > 2
+    let formatTag: UInt16 = format == .float32 ? 3 : 1 // IEEE float or PCM
+    var data = Data()
+    data.reserveCapacity(80 + dataSize)
+    func append<T: FixedWidthInteger>(_ value: T) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+    data.append(contentsOf: Array("RIFF".utf8))
+    append(UInt32(4 + 8 + (extensible ? 40 : 16) + 8 + dataSize))
+    data.append(contentsOf: Array("WAVEfmt ".utf8))
+    append(UInt32(extensible ? 40 : 16))
+    append(extensible ? 0xfffe : formatTag)
+    append(UInt16(channelCount))
+    append(UInt32(wave.sampleRate))
+    append(UInt32(Int(wave.sampleRate) * channelCount * bytesPerSample))
+    append(UInt16(channelCount * bytesPerSample))
+    append(UInt16(format.bitsPerSample))
+    if extensible {
+        append(UInt16(22)) // Extension size
+        append(UInt16(format.bitsPerSample)) // Valid bits
+        append(UInt32(0)) // Channel mask
+        append(formatTag) // The subformat GUID, KSDATAFORMAT_SUBTYPE_PCM or _IEEE_FLOAT
+        data.append(contentsOf: [0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71] as [UInt8])
+    }
+    data.append(contentsOf: Array("data".utf8))
+    append(UInt32(dataSize))
+
+    let scale = Double(1 << (format.bitsPerSample - 1))
+    for frame in 0..<frameCount {
+        for samples in wave.channels {
+            if format == .float32 {
+                append(samples[frame].bitPattern)
+            } else {
+                let value = Int32(min(max((Double(samples[frame]) * scale).rounded(), -scale), scale - 1))
+                for byte in 0..<bytesPerSample {
+                    data.append(UInt8(truncatingIfNeeded: value >> Int32(8 * byte)))
+                }
+            }
+        }
+    }
+    try data.write(to: url)
+}
+
+// MARK: - Decoding
+
+struct ChannelResult {
+    var frames: [F53Timecode] = []
+    var reversed = false
+}
+
+/// Decodes each channel in blocks the size the app's audio tap uses. Returns what was found, and
+/// how long the decoding itself took, in seconds.
+func decode(_ wave: Wave) -> ([ChannelResult], Double) {
+    let blockSize = 1024
+    var results = [ChannelResult](repeating: ChannelResult(), count: wave.channels.count)
+    for index in results.indices {
+        results[index].frames.reserveCapacity(wave.channels[index].count / 1000)
+    }
+    let start = DispatchTime.now().uptimeNanoseconds
+    for (index, samples) in wave.channels.enumerated() {
+        var decoder = LTCDecoder(sampleRate: wave.sampleRate)
+        samples.withUnsafeBufferPointer { samples in
+            var offset = 0
+            while offset < samples.count {
+                let block = UnsafeBufferPointer(rebasing: samples[offset ..< min(offset + blockSize, samples.count)])
+                decoder.decode(block) { timecode, _ in
+                    results[index].frames.append(timecode)
+                }
+                offset += blockSize
+            }
+        }
+        results[index].reversed = decoder.isReversed
+    }
+    return (results, Double(DispatchTime.now().uptimeNanoseconds - start) / 1e9)
+}
+
+func fields(_ timecode: F53Timecode) -> [UInt] {
+    return [timecode.hh, timecode.mm, timecode.ss, timecode.ff]
+}
+
+/// Frames that don't follow on from the one before, in the direction the channel is playing.
+func discontinuities(_ result: ChannelResult) -> Int {
+    var count = 0
+    for (previous, next) in zip(result.frames, result.frames.dropFirst()) {
+        let expected = result.reversed ? previous.subtracting(frames: 1) : previous.adding(frames: 1)
+        if fields(next) != fields(expected) {
+            count += 1
+        }
+    }
+    return count
+}
+
+/// Whether `result` has every frame of `expected`, in the order they were played, apart from the
+/// ones at the ends: the first, which there's no sync word before, and the last, which there's no
+/// transition after. Backwards, the sync word starts each frame, and the first one goes by while
+/// the bit clock is still locking on, so the second frame is lost too.
+func framesMatch(_ result: ChannelResult, _ expected: [F53Timecode], reversed: Bool) -> Bool {
+    let decoded = result.frames.map(fields)
+    let inOrder = (reversed ? expected.reversed() : expected).map(fields)
+    guard decoded.count >= expected.count - (reversed ? 3 : 2), decoded.count <= expected.count,
+          let first = inOrder.firstIndex(of: decoded.first ?? []) else {
+        return false
+    }
+    return Array(inOrder[first ..< min(first + decoded.count, inOrder.count)]) == decoded && result.reversed == reversed
+}
+
+// MARK: - Commands
+
+func parseFramerate(_ string: String) -> F53Timecode.Framerate? {
+    switch string {
+    case "23.976": return ._23976
+    case "24": return ._24
+    case "24.975": return ._24975
+    case "25": return ._25
+    case "29.97": return ._2997nd
+    case "29.97df": return ._2997df
+    case "30": return ._30nd
+    case "30df": return ._30df
+    default: return nil
+    }
+}
+
+func generate(_ arguments: ArraySlice<String>) {
+    var arguments = arguments
+    var framerate = F53Timecode.Framerate._30nd
+    var speed = 1.0
+    var sampleRate = 48000.0
+    var channelCount = 1
+    var seconds = 60.0
+    var format = SampleFormat.float32
+    var path: String?
+    while let argument = arguments.popFirst() {
+        switch argument {
+        case "--rate":
+            guard let value = arguments.popFirst().flatMap(parseFramerate) else { usage() }
+            framerate = value
+        case "--speed":
+            guard let value = arguments.popFirst().flatMap(Double.init), value != 0 else { usage() }
+            speed = value
+        case "--sample-rate":
+            guard let value = arguments.popFirst().flatMap(Double.init), value > 0 else { usage() }
+            sampleRate = value
+        case "--channels":
+            guard let value = arguments.popFirst().flatMap(Int.init), value > 0 else { usage() }
+            channelCount = value
+        case "--seconds":
+            guard let value = arguments.popFirst().flatMap(Double.init), value > 0 else { usage() }
+            seconds = value
+        case "--format":
+            guard let value = arguments.popFirst().flatMap(SampleFormat.init(rawValue:)) else { usage() }
+            format = value
+        default:
+            if argument.hasPrefix("-") || path != nil {
+                usage()
+            }
+            path = argument
+        }
+    }
+    guard let path else {
+        usage()
+    }
+
+    // Each channel starts an hour later than the one before, so they're easy to tell apart.
+    let frameCount = Int(seconds * framerate.nominalFPS * abs(speed))
+    let channels = (0..<channelCount).map { channel -> [Float] in
+        let start = F53Timecode(framerate: framerate, hh: UInt(channel + 1), mm: 0, ss: 0, ff: 0)
+        return ltcSamples((0..<frameCount).map { start.adding(frames: $0) }, speed: speed, sampleRate: sampleRate)
+    }
+    do {
+        try writeWave(Wave(sampleRate: sampleRate, channels: channels), to: URL(fileURLWithPath: path), format: format)
+    } catch {
+        fail("can't write \(path): \(error)")
+    }
+}
+
+func decodeFile(_ path: String) {
+    let wave: Wave
+    do {
+        wave = try readWave(URL(fileURLWithPath: path))
+    } catch {
+        fail("can't read \(path): \(error)")
+    }
+
+    let (results, elapsed) = decode(wave)
+    for (index, result) in results.enumerated() {
+        guard let first = result.frames.first, let last = result.frames.last else {
+            print("channel \(index + 1): no LTC")
+            continue
+        }
+        print("channel \(index + 1): \(result.frames.count) frames, \(first.stringRepresentation) to \(last.stringRepresentation)\(result.reversed ? " backwards" : ""), \(discontinuities(result)) discontinuities")
+    }
+
+    let duration = Double(wave.channels.first?.count ?? 0) / wave.sampleRate
+    let speed = elapsed > 0 ? duration / elapsed : 0
+    FileHandle.standardError.write(String(format: "%.3f s x %ld channels in %.3f s: %.0fx real time, %.0fx per channel\n",
+                                          duration, wave.channels.count, elapsed, speed, speed * Double(wave.channels.count)).data(using: .utf8)!)
+}
+
+func check() {
+    let framerates: [F53Timecode.Framerate] = [._23976, ._24, ._25, ._2997nd, ._2997df, ._30nd, ._30df]
+    var failures = 0
+    var tests = 0
+    var audioSeconds = 0.0
+    var elapsed = 0.0
+
+    func report(_ description: String, passed: Bool) {
+        tests += 1
+        if !passed {
+            failures += 1
+            print("FAILED: \(description)")
+        }
+    }
+
+    // Decodes `wave` and checks each channel against the frames it was made from.
+    func expect(_ expected: [[F53Timecode]], reversed: Bool, in wave: Wave, _ description: String) {
+        let (results, time) = decode(wave)
+        audioSeconds += Double(wave.channels.reduce(0) { $0 + $1.count }) / wave.sampleRate
+        elapsed += time
+        let counts = results.map { "\($0.frames.count)" }.joined(separator: ", ")
+        report("\(description): \(counts) of \(expected[0].count) frames",
+               passed: zip(results, expected).allSatisfy { framesMatch($0, $1, reversed: reversed) })
+    }
+
+    func frames(_ framerate: F53Timecode.Framerate, _ count: Int, hour: UInt = 10) -> [F53Timecode] {
+        let start = F53Timecode(framerate: framerate, hh: hour, mm: 9, ss: 59, ff: 0)
+        return (0..<count).map { start.adding(frames: $0) }
+    }
+
+    // Half a bit must span at least a couple of samples to be decodable at all.
+    func decodable(_ framerate: F53Timecode.Framerate, _ sampleRate: Double, _ speed: Double) -> Bool {
+        return sampleRate / (160 * framerate.nominalFPS * abs(speed)) >= 2
+    }
+
+    // Steady speeds, forwards and backwards.
+    for framerate in framerates {
+        for sampleRate in [44100.0, 48000, 88200, 96000, 192000] {
+            for speed in [1.0, -1, 0.1, 0.5, 2, -3, 4] where decodable(framerate, sampleRate, speed) {
+                let expected = frames(framerate, Int(max(2, 4 * abs(speed)) * framerate.nominalFPS))
+                expect([expected], reversed: speed < 0, in: Wave(sampleRate: sampleRate, channels: [ltcSamples(expected, speed: speed, sampleRate: sampleRate)]),
+                       "\(framerate.speedAgnosticDescription) (\(framerate)) at \(Int(sampleRate)) Hz, speed \(speed)")
+            }
+        }
+    }
+
+    // Speeding up and slowing down through four seconds of frames, the way a transport does as it
+    // starts, stops and shuttles, so the bit clock has to follow.
+    for framerate in framerates {
+        for sampleRate in [44100.0, 96000] {
+            for (from, to) in [(0.25, 2.0), (2, 0.25), (-0.1, -4), (-4, -0.1)] where decodable(framerate, sampleRate, max(abs(from), abs(to))) {
+                let expected = frames(framerate, Int(4 * framerate.nominalFPS))
+                let samples = ltcSamples(expected, sampleRate: sampleRate) { from + (to - from) * $0 }
+                expect([expected], reversed: from < 0, in: Wave(sampleRate: sampleRate, channels: [samples]),
+                       "\(framerate.speedAgnosticDescription) (\(framerate)) at \(Int(sampleRate)) Hz, speed \(from) to \(to)")
+            }
+        }
+    }
+
+    // Rounded edges and noise, at a normal level and then one just above LTCDecoder.minimumLevel.
+    let conditions: [(cutoff: Double, amplitude: Float, noise: Float)] = [(4000, 0.5, 0.05), (6000, 0.03, 0.005)]
+    for framerate in framerates {
+        for sampleRate in [44100.0, 48000, 96000] {
+            for speed in [1.0, -1, 2] {
+                for (index, condition) in conditions.enumerated() {
+                    let expected = frames(framerate, Int(max(2, 4 * abs(speed)) * framerate.nominalFPS))
+                    let samples = degraded(ltcSamples(expected, speed: speed, sampleRate: sampleRate, amplitude: condition.amplitude),
+                                           sampleRate: sampleRate, cutoff: condition.cutoff, noise: condition.noise, seed: UInt64(index + 1))
+                    expect([expected], reversed: speed < 0, in: Wave(sampleRate: sampleRate, channels: [samples]),
+                           "\(framerate.speedAgnosticDescription) (\(framerate)) at \(Int(sampleRate)) Hz, speed \(speed), \(Int(condition.cutoff)) Hz low-pass, level \(condition.amplitude), noise \(condition.noise)")
+                }
+            }
+        }
+    }
+
+    // Out to a file and back in every format readWave reads, and then decoded. Three channels is
+    // WAVE_FORMAT_EXTENSIBLE. Each channel starts an hour after the one before, as `generate` does.
+    let url = FileManager.default.temporaryDirectory.appendingPathComponent("tcdltc-check-\(ProcessInfo.processInfo.processIdentifier).wav")
+    func samplesMatch(_ read: Wave, _ written: Wave, tolerance: Float) -> Bool {
+        return read.sampleRate == written.sampleRate && read.channels.count == written.channels.count
+            && zip(read.channels, written.channels).allSatisfy { read, written in
+                read.count == written.count && zip(read, written).allSatisfy { abs($0 - $1) <= tolerance }
+            }
+    }
+    for format in SampleFormat.allCases {
+        for channelCount in [1, 3] {
+            let description = "\(format) WAV, \(channelCount) channels"
+            let expected = (0..<channelCount).map { frames(._2997df, 60, hour: UInt($0 + 1)) }
+            let written = Wave(sampleRate: 48000, channels: expected.enumerated().map { channel, timecodes in
+                degraded(ltcSamples(timecodes, speed: 1, sampleRate: 48000, amplitude: 0.3), sampleRate: 48000, cutoff: 8000, noise: 0.01, seed: UInt64(channel + 1))
+            })
+            do {
+                try writeWave(written, to: url, format: format)
+                let read = try readWave(url)
+                report("\(description): samples", passed: samplesMatch(read, written, tolerance: format.tolerance))
+                expect(expected, reversed: false, in: read, description)
+            } catch {
+                report("\(description): \(error)", passed: false)
+            }
+        }
+    }
+
+    // A file cut off partway through a sample frame reads up to the last whole one.
+    do {
+        let written = Wave(sampleRate: 44100, channels: [ltcSamples(frames(._25, 10), speed: 1, sampleRate: 44100),
+                                                         ltcSamples(frames(._25, 10, hour: 11), speed: -1, sampleRate: 44100)])
+        try writeWave(written, to: url, format: .int24)
+        try Data(contentsOf: url).dropLast(4).write(to: url)
+        let read = try readWave(url)
+        report("truncated WAV", passed: samplesMatch(read, Wave(sampleRate: 44100, channels: written.channels.map { Array($0.dropLast()) }),
+                                                     tolerance: SampleFormat.int24.tolerance))
+    } catch {
+        report("truncated WAV: \(error)", passed: false)
+    }
+    try? FileManager.default.removeItem(at: url)
+
+    print("\(tests - failures) of \(tests) passed")
+    FileHandle.standardError.write(String(format: "decoded %.1f s of audio in %.3f s: %.0fx real time\n", audioSeconds, elapsed, elapsed > 0 ? audioSeconds / elapsed : 0).data(using: .utf8)!)
+    exit(failures == 0 ? 0 : 1)
+}
+
+var arguments = CommandLine.arguments.dropFirst()
+switch arguments.popFirst() {
+case "generate":
+    generate(arguments)
+case "decode":
+    guard let path = arguments.popFirst(), arguments.isEmpty else {
+        usage()
+    }
+    decodeFile(path)
+case "check":
+    check()
+default:
+    usage()
+}
@@ -0,0 +1,261 @@
+//
+//  main.swift
+//  tcdreplay
+//
+//  Created on 10/17/26.
+//
+//  Replays a capture recorded with File > Record Capture… through the app's decoding and
+//  tracking, printing the events it logs to stdout and how fast it went to stderr. The events
+//  only depend on the capture, so their output can be diffed against a known-good run.
+//
+//  With --regenerate, it also runs the followed frames through the MTC output generator on a
+//  simulated batch timer, and reports how accurately the quarter frames it sends are timed.
+//
+//  With --synthetic, instead of reading a capture, it makes up frames at each MTC rate, with
+//  jitter, dropped frames, a second of silence and a jump, runs them through the same check, and
+//  exits non-zero if the output was ever late, out of order, mispacked, or didn't follow the jump.
+//
+//  It doesn't need CoreMIDI or AppKit. To build and run it anywhere Swift runs, from the
+//  repository root:
+//
+//    swift run -c release tcdreplay <capture.tcdcapture>
+//
+
+import Foundation
+@testable import TimecodeCore
+@testable import TimecodeFixtures
+
+func usage() -> Never {
+    FileHandle.standardError.write("usage: tcdreplay [--realtime] [--regenerate] [--priority | --source <unique ID>] <capture.\(CaptureFormat.pathExtension)>\n       tcdreplay --synthetic\n".data(using: .utf8)!)
+    exit(64)
+}
+
+/// Stands in for `MTCOutput`: wakes the generator on the same schedule, and instead of sending
+/// what it's given, checks it. Nothing should be scheduled in the past or out of order, quarter
+/// frames should be evenly spaced, and the frames they decode to should follow on from each other.
+/// Each batch is packed into packet lists much smaller than `MTCOutput`'s, so most batches need
+/// more than one, and the packed messages are compared with what a second generator, fed the same
+/// frames, sends all at once.
+struct OutputCheck {
+    static let batchInterval: UInt64 = 20_000_000 // As in MTCOutput
+    static let lookahead: UInt64 = 40_000_000
+    static let packetListCapacity = 2 // Messages
+
+    private var generator = MTCGenerator()
+    private var reference = MTCGenerator()
+    private var decoder = MTCDecoder()
+    private var nextBatch: UInt64?
+    private var lastNanos: UInt64?
+    private var lastDecoded: F53Timecode?
+
+    var batches = 0
+    var packetLists = 0
+    var packingErrors = 0 // Batches whose packet lists didn't hold exactly what the reference sent
+    var quarterFrames = 0
+    var late = 0 // Scheduled before the batch that sent it
+    var outOfOrder = 0
+    var discontinuities = 0 // Including the first frame after each relock
+    var intervals = 0
+    var maxIntervalError = 0.0 // ns, between neighbouring quarter frames
+    private var sumOfSquares = 0.0
+
+    var rmsIntervalError: Double {
+        return intervals > 0 ? (sumOfSquares / Double(intervals)).squareRoot() : 0
+    }
+
+    var isRunning: Bool {
+        return generator.isRunning
+    }
+
+    var summary: String {
+        return String(format: "regenerated %ld quarter frames in %ld batches, %ld packet lists; %ld late, %ld out of order, %ld discontinuities, %ld packing errors; spacing error %.1f us RMS, %.1f us max",
+                      quarterFrames, batches, packetLists, late, outOfOrder, discontinuities, packingErrors, rmsIntervalError / 1000, maxIntervalError / 1000)
+    }
+
+    mutating func takeFrame(_ timecode: F53Timecode, atNanos nanos: UInt64, isSysEx: Bool = false) {
+        run(until: nanos)
+        generator.takeFrame(timecode, atNanos: nanos, isSysEx: isSysEx)
+        reference.takeFrame(timecode, atNanos: nanos, isSysEx: isSysEx)
+    }
+
+    /// Runs batches until the generator stops of its own accord.
+    mutating func finish() {
+        if let nextBatch {
+            run(until: nextBatch + MTCGenerator.freewheelInterval + 1_000_000_000)
+        }
+    }
+
+    private mutating func run(until end: UInt64) {
+        guard generator.isRunning, var batch = nextBatch else {
+            nextBatch = end
+            return
+        }
+        while batch <= end && generator.isRunning {
+            batches += 1
+            var expected: [([UInt8], UInt64)] = []
+            reference.generate(atNanos: batch, through: batch + OutputCheck.lookahead) { bytes, nanos in
+                expected.append((Array(bytes), nanos))
+                return true
+            }
+            var sent: [([UInt8], UInt64)] = []
+            var packetList: [([UInt8], UInt64)] = []
+            var lists = 0
+            generator.generateBatches(atNanos: batch, through: batch + OutputCheck.lookahead, add: { bytes, nanos in
+                guard packetList.count < OutputCheck.packetListCapacity else {
+                    return false
+                }
+                packetList.append((Array(bytes), nanos))
+                return true
+            }, send: {
+                sent += packetList
+                packetList = []
+                lists += 1
+            })
+            packetLists += lists
+            if !packetList.isEmpty || !sent.elementsEqual(expected, by: { $0.0 == $1.0 && $0.1 == $1.1 }) {
+                packingErrors += 1
+            }
+            for (bytes, nanos) in sent {
+                bytes.withUnsafeBufferPointer { check($0, atNanos: nanos, sentAt: batch) }
+            }
+            batch += OutputCheck.batchInterval
+        }
+        nextBatch = batch
+    }
+
+    private mutating func check(_ bytes: UnsafeBufferPointer<UInt8>, atNanos nanos: UInt64, sentAt now: UInt64) {
+        quarterFrames += 1
+        if nanos < now {
+            late += 1
+        }
+        if let lastNanos, let framerate = generator.framerate {
+            if nanos < lastNanos {
+                outOfOrder += 1
+            } else {
+                let ideal = 1e9 / (4 * framerate.nominalFPS)
+                let interval = Double(nanos - lastNanos)
+                if interval < 2 * ideal { // Anything longer is a stop or relock, not a neighbour
+                    let error = abs(interval - ideal)
+                    intervals += 1
+                    sumOfSquares += error * error
+                    maxIntervalError = max(maxIntervalError, error)
+                }
+            }
+        }
+        lastNanos = nanos
+
+        var decoder = self.decoder
+        decoder.decode(bytes) { timecode, _ in
+            if let lastDecoded, timecode.framesFromZero != lastDecoded.adding(frames: 1).framesFromZero {
+                discontinuities += 1
+            }
+            lastDecoded = timecode
+        }
+        self.decoder = decoder
+    }
+}
+
+// MARK: - Synthetic input
+
+/// Runs an `OutputCheck` on 12 s of frames at `mode`'s rate, reported as `MTCDecoder` would
+/// report quarter frames: one a frame, three quarters of a frame late, up to a millisecond early
+/// or late, and one in fifty missing. None arrive for a second from 4 s, which the output should
+/// freewheel through, and at 8 s they jump ahead 100 frames, which it should relock to.
+func checkSynthetic(_ mode: MTCMode) -> OutputCheck {
+    let seconds = 12.0
+    let jitter = 1_000_000.0 // ns either way
+    let dropRate = 0.02
+    let silence = 4.0..<5.0 // Seconds
+    let jumpSeconds = 8.0
+    let jumpFrames: UInt = 100
+
+    let framerate = mode.asFramerate()
+    let fps = framerate.nominalFPS
+    let start = F53Timecode(framerate: framerate, hh: 1, mm: 0, ss: 0, ff: 0).framesFromZero
+    var random = SplitMix64(state: UInt64(mode.rawValue) + 1)
+    var check = OutputCheck()
+    for frame in 0..<Int(seconds * fps) {
+        let time = Double(frame) / fps
+        if silence.contains(time) || Double.random(in: 0..<1, using: &random) < dropRate {
+            continue
+        }
+        let jump = time >= jumpSeconds ? jumpFrames : 0
+        let nanos = UInt64(1e9 + (Double(frame) + TimecodeClock.reportLatencyFrames) / fps * 1e9 + Double.random(in: -jitter...jitter, using: &random))
+        check.takeFrame(F53Timecode(framerate: framerate, framesFromZero: start + jump + UInt(frame)), atNanos: nanos)
+    }
+    check.finish()
+    return check
+}
+
+// MARK: -
+
+var replayer = CaptureReplayer()
+var outputCheck: OutputCheck?
+var synthetic = false
+var capturePath: String?
+var arguments = CommandLine.arguments.dropFirst()
+while let argument = arguments.popFirst() {
+    switch argument {
+    case "--realtime":
+        replayer.realTime = true
+    case "--regenerate":
+        outputCheck = OutputCheck()
+    case "--synthetic":
+        synthetic = true
+    case "--priority":
+        replayer.selection = .priority
+    case "--source":
+        guard let value = arguments.popFirst(), let uniqueID = Int32(value) else {
+            usage()
+        }
+        replayer.selection = .only(uniqueID)
+    default:
+        if argument.hasPrefix("-") || capturePath != nil {
+            usage()
+        }
+        capturePath = argument
+    }
+}
+
+if synthetic {
+    guard capturePath == nil else {
+        usage()
+    }
+    var failures = 0
+    for mode in [MTCMode._24, ._25, ._30df, ._30nd] {
+        let check = checkSynthetic(mode)
+        // Only the jump should show up in the output; the jitter, drops and silence shouldn't.
+        let passed = check.late == 0 && check.outOfOrder == 0 && check.packingErrors == 0 && check.discontinuities == 1 && !check.isRunning
+        if !passed {
+            failures += 1
+        }
+        print((passed ? "" : "FAILED: ") + "\(mode.asFramerate()): " + check.summary)
+    }
+    exit(failures == 0 ? 0 : 1)
+}
+
+guard let path = capturePath else {
+    usage()
+}
+
+let reader: CaptureReader
+do {
+    reader = try CaptureReader(url: URL(fileURLWithPath: path))
+} catch {
+    FileHandle.standardError.write("tcdreplay: can't read \(path): \(error)\n".data(using: .utf8)!)
+    exit(66)
+}
+
+let summary = replayer.replay(reader, frameReceived: { entry in
+    outputCheck?.takeFrame(entry.timecode, atNanos: entry.nanos, isSysEx: entry.isSysEx)
+}, log: { record in
+    print(String(format: "%12.6f ", record.time - reader.startTime) + record.message)
+})
+outputCheck?.finish()
+
+FileHandle.standardError.write(String(format: "%ld packets, %ld bytes, %ld frames; %.3f s of capture in %.3f s (%.2f MB/s, %.0fx real time)\n",
+                                      summary.packets, summary.bytes, summary.frames, summary.captureDuration, summary.elapsed,
+                                      summary.bytesPerSecond / 1_000_000, summary.speed).data(using: .utf8)!)
+if let outputCheck {
+    FileHandle.standardError.write((outputCheck.summary + "\n").data(using: .utf8)!)
+}